@@ -0,0 +1,24 @@
+#include "allocationcounter.h"
+#include <cstdlib>
+#include <new>
+
+static thread_local std::size_t allocations = 0;
+
+std::size_t threadAllocationCount() {
+    return allocations;
+}
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (size == 0) size = 1;
+    if (void* memory = std::malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,11 @@
+#ifndef MINESWEEPER_ALLOCATIONCOUNTER_H
+#define MINESWEEPER_ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+// Number of operator new calls made so far on the calling thread. Linking
+// allocationcounter.cpp replaces the global operator new to keep this
+// count; take the difference around a block to see whether it allocates.
+std::size_t threadAllocationCount();
+
+#endif
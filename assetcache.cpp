@@ -0,0 +1,215 @@
+#include "assetcache.h"
+#include "binaryio.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+typedef std::chrono::steady_clock AssetClock;
+
+const char* const GAME_FONT_PATH = "photos/files/font.ttf";
+
+std::vector<std::string> gameImagePaths() {
+    std::vector<std::string> paths = {
+            "photos/files/images/debug.png", "photos/files/images/play.png",
+            "photos/files/images/leaderboard.png", "photos/files/images/pause.png",
+            "photos/files/images/face_happy.png", "photos/files/images/face_win.png",
+            "photos/files/images/face_lose.png", "photos/files/images/digits.png",
+            "photos/files/images/tile_hidden.png", "photos/files/images/tile_revealed.png",
+            "photos/files/images/flag.png", "photos/files/images/mine.png",
+    };
+    for (int i = 1; i < 9; ++i) {
+        paths.push_back("photos/files/images/number_" + std::to_string(i) + ".png");
+    }
+    return paths;
+}
+
+static double millisecondsSince(AssetClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(AssetClock::now() - start).count();
+}
+
+bool AssetCache::preload(const std::vector<std::string>& imagePaths, const std::vector<std::string>& fontPaths,
+                         ThreadPool& pool) {
+    AssetClock::time_point start = AssetClock::now();
+
+    // Create every entry up front; the workers then only fill in their own
+    // entries and never change the maps themselves.
+    struct Job {
+        std::string path;
+        sf::Image* image;
+        sf::Font* font;
+        double milliseconds;
+        bool loaded;
+    };
+    std::vector<Job> jobs;
+    for (const std::string& path : imagePaths) {
+        if (images.count(path)) continue;
+        jobs.push_back(Job{path, &images[path], nullptr, 0, false});
+    }
+    for (const std::string& path : fontPaths) {
+        if (fonts.count(path)) continue;
+        jobs.push_back(Job{path, nullptr, &fonts[path], 0, false});
+    }
+
+    pool.parallelFor(static_cast<int>(jobs.size()), [&jobs](int i) {
+        Job& job = jobs[i];
+        AssetClock::time_point loadStart = AssetClock::now();
+        job.loaded = job.image ? job.image->loadFromFile(job.path) : job.font->loadFromFile(job.path);
+        job.milliseconds = millisecondsSince(loadStart);
+    });
+
+    bool allLoaded = true;
+    for (const Job& job : jobs) {
+        std::cout << "asset " << job.path << ": " << job.milliseconds << " ms" << (job.loaded ? "" : " (failed)") << std::endl;
+        allLoaded = allLoaded && job.loaded;
+    }
+    std::cout << "preloaded " << jobs.size() << " assets in " << millisecondsSince(start) << " ms" << std::endl;
+    if (not allLoaded) failed = true;
+    return allLoaded;
+}
+
+bool AssetCache::loadBundle(const std::string& path) {
+    AssetClock::time_point start = AssetClock::now();
+    std::vector<char> data;
+    if (!readWholeFile(path, data)) return false;
+
+    struct Entry {
+        uint32_t kind;
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;
+        uint64_t size;
+    };
+    ByteReader reader(data.data(), data.size());
+    std::string magic;
+    uint32_t version, count;
+    if (!reader.bytes(4, magic) || magic != "MSWB" || !reader.u32(version) || version != BUNDLE_VERSION ||
+        !reader.u32(count) || count > reader.remaining() / 32) {
+        std::cerr << "Not a valid asset bundle: " << path << std::endl;
+        return false;
+    }
+    std::vector<Entry> entries(count);
+    for (Entry& entry : entries) {
+        if (!reader.u32(entry.kind) || !reader.text(entry.name, reader.remaining()) ||
+            !reader.u32(entry.width) || !reader.u32(entry.height) || !reader.u64(entry.offset) ||
+            !reader.u64(entry.size) || entry.offset > data.size() || entry.size > data.size() - entry.offset ||
+            (entry.kind == BundleImage && entry.size != 4ull * entry.width * entry.height) || entry.kind > BundleFont) {
+            std::cerr << "Corrupt asset bundle index: " << path << std::endl;
+            return false;
+        }
+    }
+
+    // Fonts keep pointing into the bundle, so it moves into the cache first.
+    bundle = std::move(data);
+    for (const Entry& entry : entries) {
+        const char* blob = bundle.data() + entry.offset;
+        if (entry.kind == BundleImage) {
+            images[entry.name].create(entry.width, entry.height, reinterpret_cast<const sf::Uint8*>(blob));
+        } else if (!fonts[entry.name].loadFromMemory(blob, entry.size)) {
+            failed = true;
+        }
+    }
+    std::cout << "loaded bundle " << path << " (" << entries.size() << " assets, " << bundle.size() << " bytes) in "
+              << millisecondsSince(start) << " ms" << std::endl;
+    return true;
+}
+
+bool AssetCache::writeBundle(const std::string& path, const std::vector<std::string>& imageNames,
+                             const std::vector<std::string>& fontPaths) {
+    struct Entry {
+        uint32_t kind;
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        std::string bytes;
+    };
+    std::vector<Entry> entries;
+    for (const std::string& name : imageNames) {
+        const sf::Image& pixels = image(name);
+        sf::Vector2u size = pixels.getSize();
+        if (size.x == 0 || size.y == 0) return false;
+        entries.push_back(Entry{BundleImage, name, size.x, size.y,
+                                std::string(reinterpret_cast<const char*>(pixels.getPixelsPtr()), 4ull * size.x * size.y)});
+    }
+    for (const std::string& fontPath : fontPaths) {
+        std::ifstream fontFile(fontPath, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(fontFile)), std::istreambuf_iterator<char>());
+        if (bytes.empty()) return false;
+        entries.push_back(Entry{BundleFont, fontPath, 0, 0, std::move(bytes)});
+    }
+
+    // Blobs start after the header and the whole index.
+    uint64_t offset = 12;
+    for (const Entry& entry : entries) {
+        offset += 32 + entry.name.size();
+    }
+    std::string header = "MSWB";
+    ByteWriter writer(header);
+    writer.u32(BUNDLE_VERSION);
+    writer.u32(static_cast<uint32_t>(entries.size()));
+    for (const Entry& entry : entries) {
+        writer.u32(entry.kind);
+        writer.text(entry.name);
+        writer.u32(entry.width);
+        writer.u32(entry.height);
+        writer.u64(offset);
+        writer.u64(entry.bytes.size());
+        offset += entry.bytes.size();
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << header;
+    for (const Entry& entry : entries) {
+        out << entry.bytes;
+    }
+    return static_cast<bool>(out);
+}
+
+const sf::Image* AssetCache::findImage(const std::string& name) const {
+    auto found = images.find(name);
+    return found == images.end() ? nullptr : &found->second;
+}
+
+const sf::Image& AssetCache::storeImage(const std::string& name, const sf::Image& image) {
+    sf::Image& stored = images[name];
+    stored = image;
+    return stored;
+}
+
+const sf::Image& AssetCache::image(const std::string& path) {
+    auto found = images.find(path);
+    if (found != images.end()) return found->second;
+
+    AssetClock::time_point start = AssetClock::now();
+    sf::Image& loaded = images[path];
+    if (!loaded.loadFromFile(path)) failed = true;
+    std::cout << "asset " << path << ": " << millisecondsSince(start) << " ms (not preloaded)" << std::endl;
+    return loaded;
+}
+
+const sf::Texture& AssetCache::texture(const std::string& path) {
+    auto found = textures.find(path);
+    if (found != textures.end()) return found->second;
+
+    AssetClock::time_point start = AssetClock::now();
+    sf::Texture& loaded = textures[path];
+    if (!loaded.loadFromImage(image(path))) failed = true;
+    std::cout << "texture " << path << ": " << millisecondsSince(start) << " ms" << std::endl;
+    return loaded;
+}
+
+const sf::Font& AssetCache::font(const std::string& path) {
+    auto found = fonts.find(path);
+    if (found != fonts.end()) return found->second;
+
+    AssetClock::time_point start = AssetClock::now();
+    sf::Font& loaded = fonts[path];
+    if (!loaded.loadFromFile(path)) failed = true;
+    std::cout << "asset " << path << ": " << millisecondsSince(start) << " ms (not preloaded)" << std::endl;
+    return loaded;
+}
+
+bool AssetCache::hasFailed() const {
+    return failed;
+}
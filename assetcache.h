@@ -0,0 +1,67 @@
+#ifndef MINESWEEPER_ASSETCACHE_H
+#define MINESWEEPER_ASSETCACHE_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "threadpool.h"
+
+// Every image file and the font the game loads, as paths relative to the
+// working directory.
+std::vector<std::string> gameImagePaths();
+extern const char* const GAME_FONT_PATH;
+
+// Every image, texture and font the game uses, loaded once and keyed by
+// path. References stay valid for the life of the cache. Lookups of a path
+// that was not preloaded load it on the spot. Each load prints its time.
+class AssetCache {
+private:
+    std::map<std::string, sf::Image> images;
+    std::map<std::string, sf::Texture> textures;
+    std::map<std::string, sf::Font> fonts;
+    // Bundle contents; fonts loaded from memory read from here for as long
+    // as they live.
+    std::vector<char> bundle;
+    bool failed = false;
+
+public:
+    // Bundle layout, all integers little-endian:
+    //   "MSWB", u32 version, u32 entry count,
+    //   per entry: u32 kind, u32 name length, name, u32 width, u32 height,
+    //              u64 offset, u64 size
+    // followed by the blobs. Images are stored as raw RGBA, so loading one
+    // needs no decoding, and fonts as their original file bytes.
+    static const uint32_t BUNDLE_VERSION = 1;
+    enum BundleKind : uint32_t {
+        BundleImage = 0,
+        BundleFont = 1,
+    };
+
+    // Fills the cache from a bundle written by writeBundle() with a single
+    // read of the file. Returns false, leaving the cache unchanged, if the
+    // file is missing or malformed.
+    bool loadBundle(const std::string& path);
+    // Packs the given cached images and fonts into one bundle file.
+    bool writeBundle(const std::string& path, const std::vector<std::string>& imageNames,
+                     const std::vector<std::string>& fontPaths);
+
+    // Decodes the images and opens the fonts in parallel on the pool. Textures
+    // are uploaded later on the calling thread, which owns the GL context.
+    // Returns false if any asset failed to load.
+    bool preload(const std::vector<std::string>& imagePaths, const std::vector<std::string>& fontPaths,
+                 ThreadPool& pool);
+    const sf::Image& image(const std::string& path);
+    // The cached image, without loading it when missing.
+    const sf::Image* findImage(const std::string& name) const;
+    // Caches an image built in memory under name, replacing any previous one.
+    const sf::Image& storeImage(const std::string& name, const sf::Image& image);
+    // Uploads from the cached image when there is one, so nothing is decoded twice.
+    const sf::Texture& texture(const std::string& path);
+    const sf::Font& font(const std::string& path);
+    // True once any load, preloaded or not, has failed.
+    bool hasFailed() const;
+};
+
+#endif
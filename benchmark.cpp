@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "allocationcounter.h"
+#include "board.h"
+#include "boardpool.h"
+#include "probability.h"
+#include "solver.h"
+#include "threadpool.h"
+#ifdef MINESWEEPER_BENCH_RENDER
+#include <SFML/Graphics.hpp>
+#include "assetcache.h"
+#include "tilemap.h"
+#endif
+
+// Times the hot paths on boards of every requested size and mine density
+// and prints the results as JSON, so two builds can be compared.
+// Usage: minesweeper_bench [--sizes 9x9,16x30] [--densities 0.12,0.2]
+//                          [--min-time ms] [--filter name]
+// Built with the game, it also times the real TileMap against an off-screen
+// render texture; run it from the directory holding photos/ for that.
+
+namespace {
+
+struct BenchSize {
+    int rows;
+    int columns;
+};
+
+struct BenchResult {
+    std::string name;
+    int rows;
+    int columns;
+    int mines;
+    long long iterations;
+    double minNs;
+    double medianNs;
+    double meanNs;
+    // Heap allocations per operation on the benchmark thread.
+    double allocations;
+};
+
+// Keeps results alive so the optimiser cannot drop the work.
+volatile long long sink = 0;
+
+// Runs setup untimed and then op timed, over and over until minTimeMs of
+// timed work and at least five runs are done, or, when setup dwarfs op,
+// until ten times that has passed in all. op may perform opsPerRun
+// operations, which the reported times are divided by.
+BenchResult measure(const std::string& name, const Board& board, double minTimeMs, int opsPerRun,
+                    const std::function<void()>& setup, const std::function<void()>& op) {
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> times;
+    double total = 0;
+    std::size_t allocations = 0;
+    // One untimed run warms caches and buffers.
+    setup();
+    op();
+    Clock::time_point began = Clock::now();
+    while (total < minTimeMs * 1e6 || times.size() < 5) {
+        if (times.size() >= 5 && std::chrono::duration<double, std::milli>(Clock::now() - began).count() > 10 * minTimeMs) {
+            break;
+        }
+        setup();
+        std::size_t allocationsBefore = threadAllocationCount();
+        Clock::time_point start = Clock::now();
+        op();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        allocations += threadAllocationCount() - allocationsBefore;
+        times.push_back(ns / opsPerRun);
+        total += ns;
+    }
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for (double t : times) sum += t;
+    return BenchResult{name, board.getRows(), board.getColumns(), board.getMineCount(),
+                       static_cast<long long>(times.size()) * opsPerRun, times.front(), times[times.size() / 2],
+                       sum / times.size(), static_cast<double>(allocations) / (times.size() * opsPerRun)};
+}
+
+// A cell in the largest connected area of cells with no mine around them,
+// where a click floods the furthest, or -1 if there is none.
+int emptyCell(const Board& board) {
+    int rows = board.getRows();
+    int columns = board.getColumns();
+    auto empty = [&](int i) {
+        return not board.hasMine(i / columns, i % columns) && board.getAdjacentMines(i / columns, i % columns) == 0;
+    };
+    std::vector<uint8_t> seen(static_cast<std::size_t>(rows) * columns);
+    std::vector<int> stack;
+    int best = -1;
+    std::size_t bestSize = 0;
+    for (int start = 0; start < rows * columns; ++start) {
+        if (seen[start] || not empty(start)) continue;
+        std::size_t size = 0;
+        seen[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+            ++size;
+            int row = i / columns, col = i % columns;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int ny = row + dy, nx = col + dx;
+                    if (ny < 0 || ny >= rows || nx < 0 || nx >= columns) continue;
+                    int next = ny * columns + nx;
+                    if (seen[next] || not empty(next)) continue;
+                    seen[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+        if (size > bestSize) {
+            bestSize = size;
+            best = start;
+        }
+    }
+    return best;
+}
+
+bool parseList(const std::string& text, std::vector<std::string>& items) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) return false;
+        items.push_back(item);
+    }
+    return !items.empty();
+}
+
+bool parseSizes(const std::string& text, std::vector<BenchSize>& sizes) {
+    std::vector<std::string> items;
+    if (!parseList(text, items)) return false;
+    sizes.clear();
+    for (const std::string& item : items) {
+        BenchSize size;
+        char x;
+        std::istringstream stream(item);
+        if (!(stream >> size.rows >> x >> size.columns) || x != 'x' || !stream.eof()) return false;
+        if (size.rows < 1 || size.columns < 1 || size.rows > 10000 || size.columns > 10000) return false;
+        sizes.push_back(size);
+    }
+    return true;
+}
+
+bool parseDensities(const std::string& text, std::vector<double>& densities) {
+    std::vector<std::string> items;
+    if (!parseList(text, items)) return false;
+    densities.clear();
+    for (const std::string& item : items) {
+        char* end;
+        double density = std::strtod(item.c_str(), &end);
+        if (*end != '\0' || !(density >= 0 && density < 1)) return false;
+        densities.push_back(density);
+    }
+    return true;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<BenchSize> sizes = {{9, 9}, {16, 16}, {16, 30}, {100, 100}, {1000, 1000}};
+    // Roughly beginner, intermediate and expert.
+    std::vector<double> densities = {0.12, 0.16, 0.21};
+    double minTimeMs = 200;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = i + 1 < argc;
+        if (ok && arg == "--sizes") ok = parseSizes(argv[++i], sizes);
+        else if (ok && arg == "--densities") ok = parseDensities(argv[++i], densities);
+        else if (ok && arg == "--min-time") ok = (minTimeMs = std::atof(argv[++i])) > 0;
+        else if (ok && arg == "--filter") filter = argv[++i];
+        else ok = false;
+        if (!ok) {
+            std::cerr << "usage: " << argv[0] << " [--sizes RxC,...] [--densities d,...] [--min-time ms] [--filter name]"
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    ThreadPool pool;
+#ifdef MINESWEEPER_BENCH_RENDER
+    // One screen of the game's largest field. Asset loading reports on
+    // stdout, which is kept for the JSON.
+    AssetCache assets;
+    std::unique_ptr<TileAtlas> atlas;
+    sf::RenderTexture target;
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+    if ((assets.loadBundle("assets.bundle") || assets.preload(gameImagePaths(), {}, pool)) && target.create(1280, 800)) {
+        atlas.reset(new TileAtlas(assets));
+    } else {
+        std::cerr << "No game assets or render target; skipping the TileMap cases" << std::endl;
+    }
+    std::cout.rdbuf(stdoutBuffer);
+#endif
+    std::vector<BenchResult> results;
+    uint64_t seed = 1;
+    for (const BenchSize& size : sizes) {
+        for (double density : densities) {
+            int cells = size.rows * size.columns;
+            // A first click always needs somewhere safe to land.
+            int mines = std::min(static_cast<int>(cells * density), cells - 1);
+            Board board(size.rows, size.columns, mines, seed);
+            auto run = [&](const std::string& name, int opsPerRun, const std::function<void()>& setup,
+                           const std::function<void()>& op) {
+                if (name.find(filter) == std::string::npos) return;
+                std::cerr << name << " " << size.rows << "x" << size.columns << " " << mines << " mines" << std::endl;
+                results.push_back(measure(name, board, minTimeMs, opsPerRun, setup, op));
+            };
+
+            // Allocation, mine placement and neighbour counts.
+            run("construct", 1, [] {}, [&] {
+                Board fresh(size.rows, size.columns, mines, ++seed);
+                sink += fresh.getSafeCellsLeft();
+            });
+            // The same without the allocation, as on a restart.
+            run("reset", 1, [] {}, [&] {
+                board.reset(mines, ++seed);
+                sink += board.getSafeCellsLeft();
+            });
+            // How a pooled board is handed to the game.
+            std::vector<Board> spares;
+            run("move_assign", 1, [&] {
+                spares.clear();
+                spares.push_back(Board(size.rows, size.columns, mines, ++seed));
+            }, [&] {
+                board = std::move(spares.back());
+            });
+            spares.clear();
+            // A restart: once warmed up the pool hands over a ready board
+            // and recycles the old one without allocating.
+            {
+                BoardPool boardPool(size.rows, size.columns, mines);
+                Board played = boardPool.take();
+                run("pool_exchange", 1, [] {}, [&] {
+                    boardPool.exchange(played);
+                    sink += played.getSafeCellsLeft();
+                });
+            }
+
+            // The opening click on the largest empty region of a fresh board.
+            int start = -1;
+            run("flood_reveal", 1, [&] {
+                board.reset(mines, ++seed);
+                start = emptyCell(board);
+            }, [&] {
+                if (start >= 0) sink += board.reveal(start / size.columns, start % size.columns).size();
+            });
+
+            // The HUD's mine counter, read once per frame.
+            board.reset(mines, ++seed);
+            for (int i = 0; i < cells; i += 7) board.rightClick(i % size.columns, i / size.columns);
+            run("flag_count", 1000, [] {}, [&] {
+                long long total = 0;
+                for (int i = 0; i < 1000; ++i) total += board.getFlagCount();
+                sink += total;
+            });
+
+            // What TileMap::update does for a full redraw, minus the vertex
+            // writes: pick every dirty cell's face. Builds without SFML only
+            // have this; with it, tilemap_update below times the real thing.
+            std::vector<uint8_t> faces(cells);
+            board.reset(mines, ++seed);
+            start = emptyCell(board);
+            if (start >= 0) board.reveal(start / size.columns, start % size.columns);
+            run("tile_faces", 1, [&] { board.markAllDirty(); }, [&] {
+                auto face = [&](int i) {
+                    int row = i / size.columns;
+                    int col = i % size.columns;
+                    switch (board.getTileState(row, col)) {
+                        case TileState::Hidden: faces[i] = 0; break;
+                        case TileState::Flagged: faces[i] = 1; break;
+                        default: faces[i] = static_cast<uint8_t>(2 + board.getAdjacentMines(row, col)); break;
+                    }
+                };
+                if (board.isAllDirty()) {
+                    for (int i = 0; i < cells; ++i) face(i);
+                } else {
+                    for (int i : board.getDirtyCells()) face(i);
+                }
+                board.clearDirty();
+                sink += faces[cells / 2];
+            });
+
+#ifdef MINESWEEPER_BENCH_RENDER
+            // The game's own draw list: a full TileMap::update(), then the
+            // part one screen shows drawn into the off-screen target.
+            if (atlas) {
+                TileMap tilemap(*atlas);
+                tilemap.resize(size.rows, size.columns, 32.0f);
+                run("tilemap_update", 1, [&] { board.markAllDirty(); }, [&] {
+                    tilemap.update(board, false, false, nullptr);
+                });
+                tilemap.cull(sf::FloatRect(0, 0, target.getSize().x, target.getSize().y), 32.0f);
+                run("tilemap_draw", 1, [] {}, [&] {
+                    target.clear(sf::Color::White);
+                    target.draw(tilemap);
+                    target.display();
+                });
+            }
+#endif
+
+            // Deductions from the opening position.
+            Solver solver(board);
+            run("solver", 1, [] {}, [&] {
+                solver.reset();
+                solver.solve();
+                sink += solver.getSafeCells().size();
+            });
+            // Exact probabilities get slow on large frontiers; keep to
+            // board sizes the overlay is used on.
+            if (cells <= 100 * 100) {
+                run("probabilities", 1, [] {}, [&] {
+                    sink += static_cast<long long>(computeMineProbabilities(board, pool).size());
+                });
+            }
+        }
+    }
+
+    std::cout << std::setprecision(6) << "{\n  \"benchmark\": \"minesweeper\",\n  \"version\": 1,\n"
+              << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n"
+              << "  \"min_time_ms\": " << minTimeMs << ",\n  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        std::cout << (i ? ",\n" : "\n") << "    {\"name\": " << jsonString(result.name) << ", \"rows\": " << result.rows
+                  << ", \"columns\": " << result.columns << ", \"mines\": " << result.mines
+                  << ", \"iterations\": " << result.iterations << ", \"min_ns\": " << result.minNs
+                  << ", \"median_ns\": " << result.medianNs << ", \"mean_ns\": " << result.meanNs
+                  << ", \"allocations\": " << result.allocations << "}";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+    return 0;
+}
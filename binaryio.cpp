@@ -0,0 +1,147 @@
+#include "binaryio.h"
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+uint32_t checksum32(const char* data, std::size_t size) {
+    uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t checksum64(const char* data, std::size_t size) {
+    const uint64_t prime = 0x100000001b3ull;
+    uint64_t lanes[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full};
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data + i + 8 * lane, 8);
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+        }
+    }
+    uint64_t hash = size;
+    for (uint64_t lane : lanes) {
+        hash = (hash ^ lane) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash ^ (hash >> 32);
+}
+
+void writeFramed(std::string& out, const std::string& payload) {
+    ByteWriter writer(out);
+    writer.u32(static_cast<uint32_t>(payload.size()));
+    writer.bytes(payload.data(), payload.size());
+    writer.u32(checksum32(payload.data(), payload.size()));
+}
+
+bool readFramed(ByteReader& reader, ByteReader& payload) {
+    ByteReader frame = reader;
+    uint32_t length, checksum;
+    if (!frame.u32(length) || frame.remaining() < static_cast<std::size_t>(length) + 4) return false;
+    const char* start = frame.current();
+    frame.skip(length);
+    if (!frame.u32(checksum) || checksum != checksum32(start, length)) return false;
+    payload = ByteReader(start, length);
+    reader = frame;
+    return true;
+}
+
+bool readWholeFile(const std::string& path, std::vector<char>& contents) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    contents.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    return static_cast<bool>(file.read(contents.data(), contents.size()));
+}
+
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool writeFileAtomically(const std::string& path, const std::string& contents) {
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+    bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size() && syncFile(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    // rename() refuses to replace an existing file on Windows.
+    return MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            mapped = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            length = static_cast<std::size_t>(fileSize.QuadPart);
+        }
+    }
+    // The mapping keeps the file open.
+    CloseHandle(file);
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) return false;
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (view != MAP_FAILED) {
+            mapped = static_cast<const char*>(view);
+            length = static_cast<std::size_t>(status.st_size);
+        }
+    }
+    // The mapping stays valid once the descriptor is closed.
+    ::close(descriptor);
+#endif
+    if (!mapped) close();
+    return mapped != nullptr;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (mapped) UnmapViewOfFile(mapped);
+    if (mapping) CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (mapped) munmap(const_cast<char*>(mapped), length);
+#endif
+    mapped = nullptr;
+    length = 0;
+}
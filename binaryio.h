@@ -0,0 +1,154 @@
+#ifndef MINESWEEPER_BINARYIO_H
+#define MINESWEEPER_BINARYIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Little-endian encoding shared by the game's binary file formats.
+class ByteWriter {
+private:
+    std::string& out;
+
+    void put(uint64_t value, int count) {
+        for (int i = 0; i < count; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+public:
+    explicit ByteWriter(std::string& out) : out(out) {}
+
+    void u8(uint8_t value) { put(value, 1); }
+    void u16(uint16_t value) { put(value, 2); }
+    void u32(uint32_t value) { put(value, 4); }
+    void u64(uint64_t value) { put(value, 8); }
+    // LEB128: seven bits per byte, low bits first, so small values take one byte.
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+    void bytes(const void* data, std::size_t size) { out.append(static_cast<const char*>(data), size); }
+    // A u32 length followed by the characters.
+    void text(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        out += value;
+    }
+    std::size_t size() const { return out.size(); }
+};
+
+// Reads what ByteWriter wrote. Every read checks the remaining length and
+// returns false instead of running past the end.
+class ByteReader {
+private:
+    const char* data;
+    std::size_t size;
+    std::size_t position = 0;
+
+    bool take(int count, uint64_t& value) {
+        if (size - position < static_cast<std::size_t>(count)) return false;
+        value = 0;
+        for (int i = 0; i < count; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data[position + i])) << (8 * i);
+        }
+        position += count;
+        return true;
+    }
+
+    template <typename T>
+    bool takeAs(int count, T& value) {
+        uint64_t wide;
+        if (!take(count, wide)) return false;
+        value = static_cast<T>(wide);
+        return true;
+    }
+
+public:
+    ByteReader(const char* data, std::size_t size) : data(data), size(size) {}
+
+    bool u8(uint8_t& value) { return takeAs(1, value); }
+    bool u16(uint16_t& value) { return takeAs(2, value); }
+    bool u32(uint32_t& value) { return takeAs(4, value); }
+    bool u64(uint64_t& value) { return take(8, value); }
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && position < size; shift += 7) {
+            unsigned char byte = static_cast<unsigned char>(data[position++]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (not (byte & 0x80)) return true;
+        }
+        return false;
+    }
+    bool bytes(std::size_t length, std::string& value) {
+        if (size - position < length) return false;
+        value.assign(data + position, length);
+        position += length;
+        return true;
+    }
+    // Reads a text() field, refusing lengths above maxLength.
+    bool text(std::string& value, std::size_t maxLength) {
+        uint32_t length;
+        return u32(length) && length <= maxLength && bytes(length, value);
+    }
+    bool skip(std::size_t length) {
+        if (size - position < length) return false;
+        position += length;
+        return true;
+    }
+    std::size_t offset() const { return position; }
+    std::size_t remaining() const { return size - position; }
+    const char* current() const { return data + position; }
+};
+
+// FNV-1a over the bytes; catches torn and corrupted records.
+uint32_t checksum32(const char* data, std::size_t size);
+
+// Word-at-a-time hash in four independent lanes, for blobs large enough
+// that checksum32's byte loop would show.
+uint64_t checksum64(const char* data, std::size_t size);
+
+// Appends payload as u32 length, payload, u32 checksum32(payload): one
+// record of an append-only log.
+void writeFramed(std::string& out, const std::string& payload);
+
+// Reads one writeFramed() record and points payload at it. Returns false on
+// a torn or corrupted record, leaving reader where it was.
+bool readFramed(ByteReader& reader, ByteReader& payload);
+
+// Reads the whole file with one read. Returns false if it cannot be opened.
+bool readWholeFile(const std::string& path, std::vector<char>& contents);
+
+// Pushes buffered writes of file to the disk, not just to the OS.
+bool syncFile(std::FILE* file);
+
+// Writes contents to a temporary file beside path, syncs it, then renames
+// it over path, so readers see either the old file or the new one whole.
+bool writeFileAtomically(const std::string& path, const std::string& contents);
+
+// Read-only view of a whole file mapped into memory. Pages are only read
+// from disk when first touched, so opening even a huge file is immediate.
+class MappedFile {
+private:
+    const char* mapped = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file cannot be opened, is empty or cannot be mapped.
+    bool open(const std::string& path);
+    void close();
+    const char* data() const { return mapped; }
+    std::size_t size() const { return length; }
+};
+
+#endif
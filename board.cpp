@@ -1,206 +1,266 @@
 #include "board.h"
-#include <random>
-#include <iostream>
+#include <algorithm>
 
-Tile::Tile() {
-    hasMine = false;
-    revealed = false;
-    flagged = false;
-    TileState new_state = TileState::Hidden;
-    state = new_state;
-    adjacentMines = 0;
+Board::Board(int numRows, int numCols, int numMines, uint64_t seed) : rows(numRows), columns(numCols) {
+    reset(numMines, seed);
 }
 
-TileState Tile::getState() const {
-    return state;
+Board::Board(int numRows, int numCols, const std::vector<int>& mineCells, uint64_t seed)
+        : rows(numRows), columns(numCols) {
+    reset(mineCells, seed);
 }
 
-void Tile::setMine(bool value) {
-    hasMine = value;
-}
+// Starts a new game on the same dimensions. Every buffer is cleared or
+// refilled with assign(), so once a board has been played nothing here
+// touches the heap.
+void Board::reset(int mines, uint64_t newSeed) {
+    clearGame(mines, newSeed);
+
+    // Floyd's sampling over flat cell indices: one draw per mine whatever
+    // the density, with the mine bit itself as the membership test.
+    Rng rng(newSeed);
+    int cellCount = rows * columns;
+    for (int j = cellCount - numMines; j < cellCount; ++j) {
+        int candidate = static_cast<int>(rng.below(j + 1));
+        cells[(cells[candidate] & MINE) ? j : candidate] |= MINE;
+    }
 
-void Tile::setAdjacentMines(int value) {
-    adjacentMines = value;
+    countAdjacentMines();
 }
 
-void Tile::setFlagged(bool value) {
-    flagged = value;
-    if (value) state = TileState::Flagged;
-    else state = TileState::Hidden;
+void Board::reset(uint64_t newSeed) {
+    reset(numMines, newSeed);
 }
 
-bool Tile::hasaMine() const {
-    return hasMine;
+void Board::reset(const std::vector<int>& mineCells, uint64_t newSeed) {
+    clearGame(static_cast<int>(mineCells.size()), newSeed);
+    for (int i : mineCells){
+        cells[i] |= MINE;
+    }
+    countAdjacentMines();
 }
 
-bool Tile::isRevealed() const {
-    return revealed;
+void Board::clearGame(int mines, uint64_t newSeed) {
+    numMines = mines;
+    seed = newSeed;
+    revealed = 0;
+    safeCellsLeft = rows * columns - mines;
+    flagsPlaced = 0;
+    correctFlags = 0;
+    listener = nullptr;
+    state = GameState::Playing;
+    paused = false;
+    allDirty = true;
+    dirtyCells.clear();
+    newlyRevealed.clear();
+    revealStack.clear();
+    cells.assign(rows * columns, 0);
 }
 
-bool Tile::isFlagged() const {
-    return flagged;
-}
+// Neighbour counts as a 3x3 box sum of the mine bits. Each row is summed
+// horizontally once over a copy padded with a zero column on either side,
+// then three consecutive row sums are added and the cell's own mine taken
+// away. Only three rows of sums are kept, and every loop is a straight pass
+// over contiguous bytes that the compiler can vectorise.
+void Board::countAdjacentMines() {
+    paddedRow.assign(columns + 2, 0);
+    rowSums.assign(3 * columns, 0);
+    uint8_t* padded = paddedRow.data();
+    uint8_t* above = rowSums.data();
+    uint8_t* current = above + columns;
+    uint8_t* below = current + columns;
+
+    auto sumRow = [&](int row, uint8_t* out) {
+        const uint8_t* source = &cells[index(row, 0)];
+        for (int c = 0; c < columns; ++c) {
+            padded[c + 1] = source[c] & MINE;
+        }
+        for (int c = 0; c < columns; ++c) {
+            out[c] = padded[c] + padded[c + 1] + padded[c + 2];
+        }
+    };
 
-int Tile::getAdjacentMines() const {
-    return adjacentMines;
-}
+    if (rows > 0) sumRow(0, current);
+    for (int r = 0; r < rows; ++r) {
+        if (r + 1 < rows) sumRow(r + 1, below);
+        else std::fill(below, below + columns, 0);
 
-void Tile::reveal(int& revealcount) {
-    if (not revealed and not flagged){
-        revealcount += 1;
-    }
-    revealed = true;
-    state = TileState::Revealed;
-    if (adjacentMines == 0 && not hasaMine()){
-        for (auto a : adjacent_tiles){
-            if (not a->isRevealed() && not a->isFlagged()) a->reveal(revealcount);
+        uint8_t* row = &cells[index(r, 0)];
+        for (int c = 0; c < columns; ++c) {
+            int count = above[c] + current[c] + below[c] - (row[c] & MINE);
+            row[c] |= count << COUNT_SHIFT;
         }
+
+        uint8_t* recycled = above;
+        above = current;
+        current = below;
+        below = recycled;
     }
 }
 
-void Tile::loadTextures() {
-    hiddenTexture.loadFromFile("photos/files/images/tile_hidden.png");
-    revealedTexture.loadFromFile("photos/files/images/tile_revealed.png");
-    mineTexture.loadFromFile("photos/files/images/mine.png");
-    flagTexture.loadFromFile("photos/files/images/flag.png");
-    for (int i = 1; i < 9; ++i) {
-        numberTextures[i].loadFromFile("photos/files/images/number_" + std::to_string(i) + ".png");
-    }
+int Board::getFlagCount() const {
+    return flagsPlaced;
 }
 
-void Tile::setTexture(sf::Texture& texture) {
-    sprite.setTexture(texture);
+int Board::getCorrectFlagCount() const {
+    return correctFlags;
 }
 
+int Board::getRevealedCount() const {
+    return revealed;
+}
 
-Board::Board(int numRows, int numCols, int numMines, TileTextures& textures, HappyFaceButton& happyface) : rows(numRows), columns(numCols), numMines(numMines) {
-    this->textures = &textures;
-    this->happyface = &happyface;
-    for (int i = 0; i < rows; ++i) {
-        std::vector<Tile*> row;
-        std::vector<bool> flag_row;
-        for (int j = 0; j < columns; ++j){
-            Tile* new_tile = new Tile;
-            row.push_back(new_tile);
-            flag_row.push_back(false);
-        }
-        tiles.push_back(row);
-        flags.push_back(flag_row);
-    }
+int Board::getSafeCellsLeft() const {
+    return safeCellsLeft;
+}
 
-    for(int i = 0; i < numMines; ++i){
-        int x_cord = rand() % (numCols - 1);
-        int y_cord = rand() % (numRows - 1);
+int Board::getRows() const {
+    return rows;
+}
 
-        while (tiles[y_cord][x_cord]->hasaMine()){
-            x_cord = rand() % (numCols - 1);
-            y_cord = rand() % (numRows - 1);
-        }
+int Board::getColumns() const {
+    return columns;
+}
 
-        tiles[y_cord][x_cord]->setMine(true);
-    }
+int Board::getMineCount() const {
+    return numMines;
+}
 
-    for (int i = 0; i < rows; ++i){
-        for (int j = 0; j < columns; ++j){
-            tiles[i][j]->setAdjacentMines(getAdjacentMineCount(i, j));
-        }
-    }
+uint64_t Board::getSeed() const {
+    return seed;
 }
 
-int Board::getFlagCount() {
-    int count = 0;
-    for (auto a : flags){
-        for (auto b: a){
-            if (b) ++count;
-        }
-    }
-    return count;
+GameState Board::getGameState() const {
+    return state;
 }
 
-void Board::draw(sf::RenderWindow& window, int tileSize){
+bool Board::isPaused() const {
+    return paused;
+}
 
-    float tileWidth = static_cast<float>(window.getSize().x) / columns;
-    float tileHeight = static_cast<float>(window.getSize().y - 100) / rows;
+void Board::setPaused(bool value) {
+    paused = value;
+}
 
-    sf::Sprite tileSprite;
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < columns; ++col) {
-            sf::Vector2f tilePosition(col * tileWidth, row * tileHeight);
+void Board::setMoveListener(MoveListener* moveListener) {
+    listener = moveListener;
+}
 
-            tileSprite.setPosition(tilePosition);
-            TileState state = tiles[row][col]->getState();
-            if (happyface->paused || (happyface->leaderboard_isopen && happyface->game_state == 0)){
-                tileSprite.setTexture(*textures->revealedTexture);
-                window.draw(tileSprite);
-            }
-            else {
-                switch (state) {
-                    case TileState::Hidden:
-                        tileSprite.setTexture(*textures->hiddenTexture);
-                        window.draw(tileSprite);
-                        if (happyface->game_state == 2) {
-                            if (tiles[row][col]->hasaMine()) {
-                                tileSprite.setTexture(*textures->mineTexture);
-                                window.draw(tileSprite);
-                            }
-                        }
-                        break;
-                    case TileState::Revealed:
-                        tileSprite.setTexture(*textures->revealedTexture);
-                        window.draw(tileSprite);
-                        if (tiles[row][col]->hasaMine()) {
-                            tileSprite.setTexture(*textures->mineTexture);
-                            window.draw(tileSprite);
-                        } else if (tiles[row][col]->getAdjacentMines() > 0) {
-                            tileSprite.setTexture(textures->numberTextures[tiles[row][col]->getAdjacentMines()]);
-                            window.draw(tileSprite);
-                        }
-                        break;
-                    case TileState::Flagged:
-                        tileSprite.setTexture(*textures->hiddenTexture);
-                        window.draw(tileSprite);
-                        tileSprite.setTexture(*textures->flaggedTexture);
-                        window.draw(tileSprite);
-                        break;
-                }
-            }
-        }
-    }
+void Board::markDirty(int cellIndex) {
+    if (cells[cellIndex] & DIRTY) return;
+    cells[cellIndex] |= DIRTY;
+    dirtyCells.push_back(cellIndex);
+}
+
+void Board::markAllDirty() {
+    allDirty = true;
+}
 
-    window.display();
+bool Board::needsRedraw() const {
+    return allDirty || !dirtyCells.empty();
+}
 
+bool Board::isAllDirty() const {
+    return allDirty;
 }
 
-void Tile::setState(TileState newState) {
-    state = newState;
+const std::vector<int>& Board::getDirtyCells() const {
+    return dirtyCells;
+}
+
+void Board::clearDirty() {
+    for (int i : dirtyCells) {
+        cells[i] &= ~DIRTY;
+    }
+    dirtyCells.clear();
+    allDirty = false;
 }
 
 TileState Board::getTileState(int row, int col) const {
     if (row < 0 || row >= rows || col < 0 || col >= columns) {
         return TileState::Hidden;
     }
-    return tiles[row][col]->getState();
+    uint8_t cell = cells[index(row, col)];
+    if (cell & REVEALED) return TileState::Revealed;
+    if (cell & FLAGGED) return TileState::Flagged;
+    return TileState::Hidden;
+}
+
+// Opens the cell and, if it has no neighbouring mines, the whole connected
+// empty region around it. Returns the indices of every cell revealed by
+// this call.
+const std::vector<int>& Board::reveal(int row, int col) {
+    newlyRevealed.clear();
+    pushReveal(index(row, col));
+    return floodReveal();
+}
+
+// Queues a hidden, unflagged cell for floodReveal(). A cell is marked
+// revealed when pushed so it is visited once.
+void Board::pushReveal(int cellIndex) {
+    uint8_t& cell = cells[cellIndex];
+    if (cell & (REVEALED | FLAGGED)) return;
+    cell |= REVEALED;
+    revealStack.push_back(cellIndex);
+}
+
+// Reveals every queued cell and floods out from those with no neighbouring
+// mines, using an explicit stack of cell indices instead of recursion. Any
+// number of cells can be queued first; the counters and dirty cells are
+// updated once for the whole batch.
+const std::vector<int>& Board::floodReveal() {
+    while (!revealStack.empty()) {
+        int current = revealStack.back();
+        revealStack.pop_back();
+        newlyRevealed.push_back(current);
+
+        uint8_t cell = cells[current];
+        if ((cell >> COUNT_SHIFT) != 0 || (cell & MINE)) continue;
+
+        int r = current / columns;
+        int c = current % columns;
+        int rowBegin = r > 0 ? r - 1 : r;
+        int rowEnd = r < rows - 1 ? r + 1 : r;
+        int colBegin = c > 0 ? c - 1 : c;
+        int colEnd = c < columns - 1 ? c + 1 : c;
+        for (int ny = rowBegin; ny <= rowEnd; ++ny) {
+            for (int nx = colBegin; nx <= colEnd; ++nx) {
+                pushReveal(index(ny, nx));
+            }
+        }
+    }
+
+    for (int i : newlyRevealed) {
+        if (not (cells[i] & MINE)) ++revealed;
+        markDirty(i);
+    }
+    safeCellsLeft = rows * columns - numMines - revealed;
+    return newlyRevealed;
+}
+
+const std::vector<int>& Board::getLastRevealed() const {
+    return newlyRevealed;
 }
 
 bool Board::leftClick(int x, int y) {
-    if (x < 0 || x >= columns || y < 0 || y >= rows || tiles[y][x]->isFlagged() || happyface->game_state == -1 || happyface->game_state == 1 || happyface->paused) {
+    newlyRevealed.clear();
+    if (x < 0 || x >= columns || y < 0 || y >= rows || isFlagged(y, x) || state != GameState::Playing || paused) {
         return false;
     }
-    TileState clickedTileState = tiles[y][x]->getState();
+    TileState clickedTileState = getTileState(y, x);
     switch(clickedTileState) {
         case TileState::Revealed:
             break;
         default:
-            if (tiles[y][x]->hasaMine()){
+            if (listener) listener->moved(MoveKind::Reveal, index(y, x));
+            if (hasMine(y, x)){
                 revealAllMines();
-                happyface->setLoseFace();
-                happyface->game_state = -1;
+                state = GameState::Lost;
                 break;
             }
-            tiles[y][x]->reveal(revealed);
-            if (revealed == rows * columns - numMines) {
-                happyface->setWinFace();
-                happyface->game_state = 1;
+            reveal(y, x);
+            if (safeCellsLeft == 0) {
+                state = GameState::Won;
                 return true;
             }
             break;
@@ -208,96 +268,118 @@ bool Board::leftClick(int x, int y) {
     return false;
 }
 
+// Chording: on a revealed number with exactly that many flags around it,
+// opens every other neighbour in one batched reveal. A wrong flag means a
+// mine is among them and the game is lost. Returns true on a win.
+bool Board::chord(int x, int y) {
+    newlyRevealed.clear();
+    if (x < 0 || x >= columns || y < 0 || y >= rows || not isRevealed(y, x) || state != GameState::Playing || paused) {
+        return false;
+    }
+    int number = getAdjacentMines(y, x);
+    if (number == 0 || hasMine(y, x)) return false;
+
+    int rowBegin = y > 0 ? y - 1 : y;
+    int rowEnd = y < rows - 1 ? y + 1 : y;
+    int colBegin = x > 0 ? x - 1 : x;
+    int colEnd = x < columns - 1 ? x + 1 : x;
+    int flags = 0;
+    bool hitMine = false;
+    for (int ny = rowBegin; ny <= rowEnd; ++ny) {
+        for (int nx = colBegin; nx <= colEnd; ++nx) {
+            uint8_t cell = cells[index(ny, nx)];
+            if (cell & FLAGGED) ++flags;
+            else if (not (cell & REVEALED) && (cell & MINE)) hitMine = true;
+        }
+    }
+    if (flags != number) return false;
+    if (listener) listener->moved(MoveKind::Chord, index(y, x));
+
+    for (int ny = rowBegin; ny <= rowEnd; ++ny) {
+        for (int nx = colBegin; nx <= colEnd; ++nx) {
+            pushReveal(index(ny, nx));
+        }
+    }
+    floodReveal();
+
+    if (hitMine) {
+        revealAllMines();
+        state = GameState::Lost;
+        return false;
+    }
+    if (safeCellsLeft == 0) {
+        state = GameState::Won;
+        return true;
+    }
+    return false;
+}
+
 void Board::rightClick(int x, int y) {
-    if (x < 0 || x >= columns || y < 0 || y >= rows || tiles[y][x]->isRevealed() || happyface->game_state == -1 || happyface->game_state == 1 || happyface->paused) {
+    if (x < 0 || x >= columns || y < 0 || y >= rows || isRevealed(y, x) || state != GameState::Playing || paused) {
         return;
     }
-    flags[y][x] = not flags[y][x];
-    tiles[y][x]->setFlagged(not tiles[y][x]->isFlagged());
+    if (listener) listener->moved(MoveKind::Flag, index(y, x));
+    uint8_t& cell = cells[index(y, x)];
+    cell ^= FLAGGED;
+    int change = (cell & FLAGGED) ? 1 : -1;
+    flagsPlaced += change;
+    if (cell & MINE) correctFlags += change;
+    markDirty(index(y, x));
 }
 
-int Board::getAdjacentMineCount(int x, int y) const {
+int Board::getAdjacentMineCount(int row, int col) const {
     static const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
     static const int dy[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
 
     int count = 0;
     for (int i = 0; i < 8; ++i) {
-        int nx = x + dx[i];
-        int ny = y + dy[i];
-        if (nx >= 0 && nx < rows && ny >= 0 && ny < columns) {
-            tiles[x][y]->adjacent_tiles.push_back(tiles[nx][ny]);
-            if (tiles[nx][ny]->hasaMine()){
+        int ny = row + dy[i];
+        int nx = col + dx[i];
+        if (ny >= 0 && ny < rows && nx >= 0 && nx < columns) {
+            if (hasMine(ny, nx)){
                 ++count;
             }
         }
-
-
     }
     return count;
 }
 
 void Board::revealAllMines() {
-    for (int y = 0; y < rows; ++y) {
-        for (int x = 0; x < columns; ++x) {
-            if (tiles[y][x]->hasaMine()) {
-                tiles[y][x]->setState(TileState::Revealed);
-                tiles[y][x]->reveal(revealed);
-            }
+    int cellCount = rows * columns;
+    for (int i = 0; i < cellCount; ++i) {
+        if (cells[i] & MINE) {
+            cells[i] |= REVEALED;
+            markDirty(i);
         }
     }
 }
 
-Board& Board::operator=(const Board& other_board){
-    for (auto a : tiles){
-        for (auto b : a){
-            delete b;
-        }
-        a.clear();
-    }
-    tiles.clear();
-
-    for (auto a: flags){
-        a.clear();
+void Board::snapshot(BoardSnapshot& snapshot) const {
+    snapshot.rows = rows;
+    snapshot.columns = columns;
+    snapshot.mines = numMines;
+    snapshot.seed = seed;
+    snapshot.state = state;
+    snapshot.paused = paused;
+    snapshot.revealed = revealed;
+    snapshot.flagsPlaced = flagsPlaced;
+    snapshot.correctFlags = correctFlags;
+    snapshot.cells.resize(cells.size());
+    uint8_t* out = snapshot.cells.data();
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        out[i] = cells[i] & static_cast<uint8_t>(~DIRTY);
     }
-    flags.clear();
-
-    revealed = 0;
-    for (int i = 0; i < rows; ++i) {
-        std::vector<Tile*> row;
-        std::vector<bool> flag_row;
-        for (int j = 0; j < columns; ++j){
-            Tile* new_tile = new Tile;
-
-            new_tile->setMine(other_board.tiles[i][j]->hasaMine());
-            row.push_back(new_tile);
-            flag_row.push_back(false);
-        }
-        tiles.push_back(row);
-        flags.push_back(flag_row);
-    }
-
-    for (int i = 0; i < rows; ++i){
-        for (int j = 0; j < columns; ++j){
-            tiles[i][j]->setAdjacentMines(getAdjacentMineCount(i, j));
-        }
-    }
-
-    return *this;
 }
 
-Board::~Board(){
-    for (auto a : tiles){
-        for (auto b : a){
-            delete b;
-        }
-        a.clear();
-    }
-    tiles.clear();
+void Board::restore(const BoardSnapshot& saved, const uint8_t* cellBytes) {
+    rows = saved.rows;
+    columns = saved.columns;
+    clearGame(saved.mines, saved.seed);
+    cells.assign(cellBytes, cellBytes + cells.size());
+    state = saved.state;
+    paused = saved.paused;
+    revealed = saved.revealed;
+    flagsPlaced = saved.flagsPlaced;
+    correctFlags = saved.correctFlags;
+    safeCellsLeft = rows * columns - numMines - revealed;
 }
-
-
-
-
-
-
-
@@ -1,10 +1,10 @@
 #ifndef MINESWEEPER_BOARD_H
 #define MINESWEEPER_BOARD_H
 
-#include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
-#include "button.h"
+#include "rng.h"
 
 enum class TileState {
     Hidden,
@@ -12,97 +12,129 @@ enum class TileState {
     Flagged,
 };
 
-struct TileTextures {
-    sf::Texture* hiddenTexture = new sf::Texture;
-
-
-    sf::Texture* revealedTexture = new sf::Texture;
-
-
-    sf::Texture* flaggedTexture = new sf::Texture;
-
-
-    sf::Texture* mineTexture = new sf::Texture;
-
-
-    sf::Texture* numberTextures = new sf::Texture[9];
-
-
-    TileTextures(){
-        hiddenTexture->loadFromFile("photos/files/images/tile_hidden.png");
-        revealedTexture->loadFromFile("photos/files/images/tile_revealed.png");
-        flaggedTexture->loadFromFile("photos/files/images/flag.png");
-        mineTexture->loadFromFile("photos/files/images/mine.png");
-        for (int i = 1; i < 9; ++i) {
-            numberTextures[i].loadFromFile("photos/files/images/number_" + std::to_string(i) + ".png");
-        }
-    }
-
-    ~TileTextures(){
-        delete hiddenTexture;
-        delete revealedTexture;
-        delete flaggedTexture;
-        delete mineTexture;
-        delete[] numberTextures;
-    }
+enum class GameState {
+    Playing,
+    Won,
+    Lost,
 };
 
-class Tile {
-private:
-    bool hasMine;
-    bool revealed;
-    bool flagged;
-    int adjacentMines;
-    sf::Sprite sprite;
-    sf::Texture hiddenTexture;
-    sf::Texture revealedTexture;
-    sf::Texture flagTexture;
-    TileState state;
+enum class MoveKind : uint8_t {
+    Reveal,
+    Flag,
+    Chord,
+};
 
+// Told about every move a board accepts, just before it is applied; used
+// to record replays.
+class MoveListener {
 public:
-    std::vector<Tile*> adjacent_tiles;
-    sf::Texture mineTexture;
-    sf::Texture numberTextures[9];
-    Tile();
-    void setState(TileState newState);
-    void setMine(bool value);
-    void setAdjacentMines(int value);
-    void setFlagged(bool value);
-    bool hasaMine() const;
-    bool isRevealed() const;
-    bool isFlagged() const;
-    int getAdjacentMines() const;
-    void reveal(int& revealcount);
-    void loadTextures();
-    TileState getState() const;
-    void setTexture(sf::Texture& texture);
-    void draw(sf::RenderWindow& window);
+    virtual ~MoveListener() {}
+    virtual void moved(MoveKind kind, int cellIndex) = 0;
 };
 
+// A board's whole game state, for saving a game in progress. cells holds
+// the board's own one-byte-per-cell encoding.
+struct BoardSnapshot {
+    int rows = 0;
+    int columns = 0;
+    int mines = 0;
+    uint64_t seed = 0;
+    GameState state = GameState::Playing;
+    bool paused = false;
+    int revealed = 0;
+    int flagsPlaced = 0;
+    int correctFlags = 0;
+    std::vector<uint8_t> cells;
+};
 
 class Board {
 private:
+    // Each cell is one byte in a single row-major vector: the low bits hold
+    // the mine/revealed/flagged state and the high nibble the neighbour count.
+    static const uint8_t MINE = 1 << 0;
+    static const uint8_t REVEALED = 1 << 1;
+    static const uint8_t FLAGGED = 1 << 2;
+    static const uint8_t DIRTY = 1 << 3;
+    static const int COUNT_SHIFT = 4;
+
     int rows;
-    TileTextures* textures;
     int columns;
-    std::vector<std::vector<Tile*>> tiles;
-    std::vector<std::vector<bool>> flags;
-    HappyFaceButton* happyface;
-    int numMines;
-public:
+    std::vector<uint8_t> cells;
+    std::vector<int> revealStack;
+    std::vector<int> newlyRevealed;
+    std::vector<int> dirtyCells;
+    // Scratch rows for countAdjacentMines(), kept so a reset reuses them.
+    std::vector<uint8_t> paddedRow;
+    std::vector<uint8_t> rowSums;
+    bool allDirty = true;
+    GameState state = GameState::Playing;
+    bool paused = false;
+    int numMines = 0;
+    uint64_t seed = 0;
+    // Running totals kept by reset(), reveal() and rightClick() so the HUD
+    // and the win check never scan the grid.
     int revealed = 0;
-    int getFlagCount();
-    Board(int numRows, int numCols, int numMines, TileTextures& textures, HappyFaceButton& happyface);
-    void initialize();
-    void draw(sf::RenderWindow& window, int tileSize);
+    int safeCellsLeft = 0;
+    int flagsPlaced = 0;
+    int correctFlags = 0;
+    MoveListener* listener = nullptr;
+
+    int index(int row, int col) const { return row * columns + col; }
+    void markDirty(int cellIndex);
+    void countAdjacentMines();
+    void clearGame(int mines, uint64_t newSeed);
+    void pushReveal(int cellIndex);
+    const std::vector<int>& floodReveal();
+public:
+    int getFlagCount() const;
+    int getCorrectFlagCount() const;
+    int getRevealedCount() const;
+    int getSafeCellsLeft() const;
+    // The same seed and dimensions always give the same mine layout.
+    Board(int numRows, int numCols, int numMines, uint64_t seed = randomSeed());
+    // Builds the board with mines exactly on the given cell indices; seed
+    // only records where the layout came from.
+    Board(int numRows, int numCols, const std::vector<int>& mineCells, uint64_t seed = 0);
+    // Boards are moved, never copied: a new game reuses a board with reset().
+    Board(const Board&) = delete;
+    Board& operator=(const Board&) = delete;
+    Board(Board&&) = default;
+    Board& operator=(Board&&) = default;
+    void reset(int numMines, uint64_t seed);
+    void reset(uint64_t seed);
+    void reset(const std::vector<int>& mineCells, uint64_t seed);
+    int getRows() const;
+    int getColumns() const;
+    int getMineCount() const;
+    uint64_t getSeed() const;
+    GameState getGameState() const;
+    bool isPaused() const;
+    void setPaused(bool value);
+    // Reports accepted moves to listener until the next reset(); nullptr stops.
+    void setMoveListener(MoveListener* moveListener);
+    void markAllDirty();
+    bool needsRedraw() const;
+    bool isAllDirty() const;
+    const std::vector<int>& getDirtyCells() const;
+    void clearDirty();
     TileState getTileState(int row, int col) const;
+    bool hasMine(int row, int col) const { return cells[index(row, col)] & MINE; }
+    bool isRevealed(int row, int col) const { return cells[index(row, col)] & REVEALED; }
+    bool isFlagged(int row, int col) const { return cells[index(row, col)] & FLAGGED; }
+    int getAdjacentMines(int row, int col) const { return cells[index(row, col)] >> COUNT_SHIFT; }
+    const std::vector<int>& reveal(int row, int col);
+    const std::vector<int>& getLastRevealed() const;
     bool leftClick(int x, int y);
+    bool chord(int x, int y);
     void rightClick(int x, int y);
-    void revealAdjacentTiles(int x, int y);
-    int getAdjacentMineCount(int x, int y) const;
+    int getAdjacentMineCount(int row, int col) const;
     void revealAllMines();
-    ~Board();
-    Board& operator=(const Board& other_board);
+    // Copies the game into snapshot, reusing its buffer.
+    void snapshot(BoardSnapshot& snapshot) const;
+    // Replaces the game, dimensions included, with a saved one whose cells
+    // are read from cellBytes, e.g. straight out of a mapped file. The
+    // counters are taken from saved rather than recounted.
+    void restore(const BoardSnapshot& saved, const uint8_t* cellBytes);
 };
 
 #endif
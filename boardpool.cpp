@@ -0,0 +1,92 @@
+#include "boardpool.h"
+#include <algorithm>
+#include <utility>
+
+BoardPool::BoardPool(int numRows, int numCols, int numMines, std::size_t capacity)
+        : BoardPool(numRows, numCols, [numMines](Board& board, const std::atomic<bool>&) { board.reset(numMines, randomSeed()); }, capacity) {
+}
+
+BoardPool::BoardPool(int numRows, int numCols, Generator regenerate, std::size_t capacity)
+        : regenerate(std::move(regenerate)), cancelled(false) {
+    capacity = std::max<std::size_t>(capacity, 1);
+    // Empty placeholders; the worker fills each one before it is handed out.
+    for (std::size_t i = 0; i < capacity; ++i) {
+        boards.emplace_back(numRows, numCols, std::vector<int>());
+    }
+    status.assign(capacity, SlotStatus::Stale);
+    readyOrder.assign(capacity, 0);
+    worker = std::thread(&BoardPool::workerLoop, this);
+}
+
+BoardPool::~BoardPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cancelled.store(true);
+    spaceAvailable.notify_all();
+    worker.join();
+}
+
+void BoardPool::workerLoop() {
+    while (true) {
+        std::size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto stale = status.end();
+            spaceAvailable.wait(lock, [&] {
+                stale = std::find(status.begin(), status.end(), SlotStatus::Stale);
+                return stopping || stale != status.end();
+            });
+            if (stopping) return;
+            slot = stale - status.begin();
+            status[slot] = SlotStatus::Generating;
+        }
+
+        // Nobody else touches a slot while it is Generating, so the board is
+        // rebuilt without holding the lock.
+        regenerate(boards[slot], cancelled);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            status[slot] = SlotStatus::Ready;
+            readyOrder[slot] = nextOrder++;
+        }
+        boardReady.notify_one();
+    }
+}
+
+int BoardPool::waitForReady(std::unique_lock<std::mutex>& lock) {
+    int slot = -1;
+    boardReady.wait(lock, [&] {
+        for (std::size_t i = 0; i < status.size(); ++i) {
+            if (status[i] == SlotStatus::Ready && (slot < 0 || readyOrder[i] < readyOrder[slot])) slot = static_cast<int>(i);
+        }
+        return slot >= 0;
+    });
+    return slot;
+}
+
+Board BoardPool::take() {
+    std::unique_lock<std::mutex> lock(mutex);
+    int slot = waitForReady(lock);
+    Board board = std::move(boards[slot]);
+    status[slot] = SlotStatus::Stale;
+    lock.unlock();
+    spaceAvailable.notify_one();
+    return board;
+}
+
+void BoardPool::exchange(Board& board) {
+    std::unique_lock<std::mutex> lock(mutex);
+    int slot = waitForReady(lock);
+    std::swap(board, boards[slot]);
+    status[slot] = SlotStatus::Stale;
+    lock.unlock();
+    spaceAvailable.notify_one();
+}
+
+std::size_t BoardPool::readyCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::count(status.begin(), status.end(), SlotStatus::Ready);
+}
@@ -0,0 +1,63 @@
+#ifndef MINESWEEPER_BOARDPOOL_H
+#define MINESWEEPER_BOARDPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "board.h"
+
+// Generates boards for one configuration on a worker thread and keeps up to
+// `capacity` of them ready. The pool owns a fixed set of boards: exchange()
+// swaps a finished game for a ready board and the worker regenerates the
+// old one in place, so after warm-up a restart never allocates.
+class BoardPool {
+public:
+    // Refills a board in place for a new game, normally via Board::reset().
+    // A slow generator should give up once stop is set: the pool is being
+    // destroyed and waits for it.
+    typedef std::function<void(Board&, const std::atomic<bool>& stop)> Generator;
+
+private:
+    enum class SlotStatus {
+        Stale,
+        Generating,
+        Ready,
+    };
+
+    Generator regenerate;
+    std::vector<Board> boards;
+    std::vector<SlotStatus> status;
+    // Boards are handed out in the order they were generated.
+    std::vector<uint64_t> readyOrder;
+    uint64_t nextOrder = 0;
+    std::mutex mutex;
+    std::condition_variable boardReady;
+    std::condition_variable spaceAvailable;
+    bool stopping = false;
+    // stopping for the generator, which runs without the lock.
+    std::atomic<bool> cancelled;
+    // Declared last so everything above exists before the worker starts.
+    std::thread worker;
+
+    void workerLoop();
+    int waitForReady(std::unique_lock<std::mutex>& lock);
+public:
+    BoardPool(int numRows, int numCols, int numMines, std::size_t capacity = 4);
+    BoardPool(int numRows, int numCols, Generator regenerate, std::size_t capacity = 4);
+    ~BoardPool();
+    BoardPool(const BoardPool&) = delete;
+    BoardPool& operator=(const BoardPool&) = delete;
+
+    // Returns a fresh board, waiting for the worker only if none is ready.
+    Board take();
+    // Swaps board with a fresh one and recycles the old one's storage.
+    void exchange(Board& board);
+    std::size_t readyCount();
+};
+
+#endif
@@ -13,7 +13,7 @@ void Button::setPosition(const sf::Vector2f& pos) {
     sprite.setPosition(position);
 }
 
-void Button::setTexture(sf::Texture& texture) {
+void Button::setTexture(const sf::Texture& texture) {
     sprite.setTexture(texture);
 }
 
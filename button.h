@@ -3,12 +3,13 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <string>
+#include "assetcache.h"
 
 class Button {
 public:
 
     Button(const sf::Texture& texture, const sf::Vector2f& pos, const sf::Vector2f& size);
-    void setTexture(sf::Texture& texture);
+    void setTexture(const sf::Texture& texture);
     void setPosition(const sf::Vector2f& pos);
     bool contains(const sf::Vector2f& point) const;
     void draw(sf::RenderWindow& window) const;
@@ -27,22 +28,19 @@ private:
 
 class HappyFaceButton {
 private:
-    sf::Texture happyTexture;
-    sf::Texture winTexture;
-    sf::Texture loseTexture;
+    const sf::Texture& happyTexture;
+    const sf::Texture& winTexture;
+    const sf::Texture& loseTexture;
     sf::Sprite buttonSprite;
 
 
 public:
-    int game_state = 0;
-    bool paused = false;
+    bool debug = false;
     bool leaderboard_isopen = false;
-    HappyFaceButton() {
-
-        happyTexture.loadFromFile("photos/files/images/face_happy.png");
-        winTexture.loadFromFile("photos/files/images/face_win.png");
-        loseTexture.loadFromFile("photos/files/images/face_lose.png");
-
+    explicit HappyFaceButton(AssetCache& assets)
+            : happyTexture(assets.texture("photos/files/images/face_happy.png")),
+              winTexture(assets.texture("photos/files/images/face_win.png")),
+              loseTexture(assets.texture("photos/files/images/face_lose.png")) {
         buttonSprite.setTexture(happyTexture);
     }
 
@@ -55,11 +53,7 @@ public:
     }
 
     bool handleClick(float mouseX, float mouseY) {
-        if (buttonSprite.getGlobalBounds().contains(mouseX, mouseY)) {
-            game_state = 0;
-            return true;
-        }
-        return false;
+        return buttonSprite.getGlobalBounds().contains(mouseX, mouseY);
     }
 
     void setWinFace() {
@@ -78,14 +72,11 @@ public:
 
 class Digit {
 private:
-    sf::Texture texture;
     sf::Sprite sprite;
     int digit;
 
 public:
-    Digit(const std::string& digitTexturePath) : digit(0) {
-        if (!texture.loadFromFile(digitTexturePath)) {
-        }
+    explicit Digit(const sf::Texture& texture) : digit(0) {
         sprite.setTexture(texture);
         sprite.setTextureRect(sf::IntRect(0, 0, 21, 32));
     }
@@ -0,0 +1,78 @@
+#include "camera.h"
+#include <algorithm>
+#include <cstdlib>
+
+Camera::Camera(sf::Vector2f boardSize, sf::Vector2f screenSize, sf::Vector2u windowSize, float tileSize)
+        : boardSize(boardSize), screenSize(screenSize) {
+    view.setViewport(sf::FloatRect(0, 0, screenSize.x / windowSize.x, screenSize.y / windowSize.y));
+    float fitScale = std::max(boardSize.x / screenSize.x, boardSize.y / screenSize.y);
+    minScale = 0.5f;
+    maxScale = std::max(1.0f, std::min(fitScale, tileSize));
+    apply(sf::Vector2f(boardSize.x / 2, boardSize.y / 2));
+}
+
+// Sizes the view for the current scale and centres it as close to center
+// as the board edges allow.
+void Camera::apply(sf::Vector2f center) {
+    sf::Vector2f size(screenSize.x * scale, screenSize.y * scale);
+    auto clampAxis = [](float value, float half, float limit) {
+        if (2 * half >= limit) return limit / 2;
+        return std::max(half, std::min(value, limit - half));
+    };
+    view.setSize(size);
+    view.setCenter(clampAxis(center.x, size.x / 2, boardSize.x), clampAxis(center.y, size.y / 2, boardSize.y));
+}
+
+const sf::View& Camera::getView() const {
+    return view;
+}
+
+sf::FloatRect Camera::visibleArea() const {
+    sf::Vector2f center = view.getCenter();
+    sf::Vector2f size = view.getSize();
+    return sf::FloatRect(center.x - size.x / 2, center.y - size.y / 2, size.x, size.y);
+}
+
+float Camera::pixelsPerCell(float tileSize) const {
+    return tileSize / scale;
+}
+
+bool Camera::containsPixel(sf::Vector2i pixel) const {
+    return pixel.x >= 0 && pixel.y >= 0 && pixel.x < screenSize.x && pixel.y < screenSize.y;
+}
+
+sf::Vector2f Camera::mapPixel(const sf::RenderTarget& target, sf::Vector2i pixel) const {
+    return target.mapPixelToCoords(pixel, view);
+}
+
+bool Camera::zoomAt(const sf::RenderTarget& target, sf::Vector2i pixel, float factor) {
+    float newScale = std::max(minScale, std::min(scale * factor, maxScale));
+    if (newScale == scale) return false;
+    sf::Vector2f anchor = mapPixel(target, pixel);
+    scale = newScale;
+    // Put the anchor back under the cursor.
+    apply(sf::Vector2f(anchor.x - (pixel.x - screenSize.x / 2) * scale,
+                       anchor.y - (pixel.y - screenSize.y / 2) * scale));
+    return true;
+}
+
+void Camera::beginDrag(sf::Vector2i pixel) {
+    dragging = true;
+    dragged = false;
+    dragFrom = pixel;
+    centerFrom = view.getCenter();
+}
+
+bool Camera::dragTo(sf::Vector2i pixel) {
+    if (not dragging) return false;
+    if (not dragged && std::abs(pixel.x - dragFrom.x) + std::abs(pixel.y - dragFrom.y) < DRAG_THRESHOLD) return false;
+    dragged = true;
+    sf::Vector2f before = view.getCenter();
+    apply(sf::Vector2f(centerFrom.x - (pixel.x - dragFrom.x) * scale, centerFrom.y - (pixel.y - dragFrom.y) * scale));
+    return view.getCenter() != before;
+}
+
+bool Camera::endDrag() {
+    dragging = false;
+    return dragged;
+}
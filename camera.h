@@ -0,0 +1,50 @@
+#ifndef MINESWEEPER_CAMERA_H
+#define MINESWEEPER_CAMERA_H
+
+#include <SFML/Graphics.hpp>
+
+// The view onto the board, drawn into the top left screenSize pixels of
+// the window. Board coordinates are in board pixels, tileSize per cell.
+// The wheel zooms about the cursor and dragging pans; the view never
+// leaves the board, centres it when it is smaller than the screen, and
+// zooms out at most to one screen pixel per cell or to the whole board,
+// whichever comes first.
+class Camera {
+private:
+    sf::View view;
+    sf::Vector2f boardSize;
+    sf::Vector2f screenSize;
+    // Board pixels per screen pixel.
+    float scale = 1;
+    float minScale;
+    float maxScale;
+    bool dragging = false;
+    bool dragged = false;
+    sf::Vector2i dragFrom;
+    sf::Vector2f centerFrom;
+
+    void apply(sf::Vector2f center);
+public:
+    static const int DRAG_THRESHOLD = 4;
+
+    Camera(sf::Vector2f boardSize, sf::Vector2f screenSize, sf::Vector2u windowSize, float tileSize);
+    const sf::View& getView() const;
+    // The part of the board on screen, in board pixels.
+    sf::FloatRect visibleArea() const;
+    float pixelsPerCell(float tileSize) const;
+    bool containsPixel(sf::Vector2i pixel) const;
+    // The board pixel under a window pixel.
+    sf::Vector2f mapPixel(const sf::RenderTarget& target, sf::Vector2i pixel) const;
+
+    // Zooms in for factor < 1, keeping the point under pixel in place.
+    // Returns false if already at the limit.
+    bool zoomAt(const sf::RenderTarget& target, sf::Vector2i pixel, float factor);
+    void beginDrag(sf::Vector2i pixel);
+    // Pans once the cursor has moved DRAG_THRESHOLD pixels from where the
+    // drag began. Returns true if the view moved.
+    bool dragTo(sf::Vector2i pixel);
+    // Returns true if the drag panned, so the press was not a click.
+    bool endDrag();
+};
+
+#endif
@@ -0,0 +1,353 @@
+#include "endlessboard.h"
+#include <algorithm>
+#include <iostream>
+#include "binaryio.h"
+#include "rng.h"
+
+// Cache record payload: u64 chunk key, then the revealed and the flagged
+// bits of the chunk, one bit per cell in row-major order.
+static const std::size_t BITMAP_SIZE = EndlessBoard::CHUNK_SIZE * EndlessBoard::CHUNK_SIZE / 8;
+static const std::size_t PAYLOAD_SIZE = 8 + 2 * BITMAP_SIZE;
+static const std::size_t RECORD_SIZE = 4 + PAYLOAD_SIZE + 4;
+// Small caches are never worth compacting.
+static const std::size_t MIN_COMPACT_RECORDS = 256;
+
+EndlessBoard::EndlessBoard(uint64_t seed, int minesPerChunk, const std::string& cachePath, std::size_t maxLoadedChunks)
+        : seed(seed), minesPerChunk(std::max(CHUNK_CELLS / 8, std::min(minesPerChunk, CHUNK_CELLS - 1))),
+          maxLoaded(std::max<std::size_t>(maxLoadedChunks, 1)), cachePath(cachePath), cacheFilePath(cachePath) {
+    // The cache only lives as long as this board.
+    if (!cachePath.empty()) cache = std::fopen(cacheFilePath.c_str(), "w+b");
+    if (!cache) std::cerr << "No chunk cache, opened chunks will stay in memory" << std::endl;
+}
+
+EndlessBoard::~EndlessBoard() {
+    if (cache) {
+        std::fclose(cache);
+        std::remove(cacheFilePath.c_str());
+    }
+}
+
+uint64_t EndlessBoard::chunkKey(int chunkRow, int chunkCol) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(chunkRow)) << 32 | static_cast<uint32_t>(chunkCol);
+}
+
+// Rounds towards negative infinity, so cell -1 is in chunk -1.
+int EndlessBoard::chunkOf(int coordinate) {
+    return coordinate >= 0 ? coordinate / CHUNK_SIZE : (coordinate - (CHUNK_SIZE - 1)) / CHUNK_SIZE;
+}
+
+bool EndlessBoard::inWorld(int row, int col) {
+    return row > -WORLD_LIMIT && row < WORLD_LIMIT && col > -WORLD_LIMIT && col < WORLD_LIMIT;
+}
+
+// Floyd's sampling as in Board::reset(), from an Rng seeded by the world
+// seed and the chunk coordinate, minus any mine next to the origin.
+void EndlessBoard::placeMines(int chunkRow, int chunkCol, uint8_t* mines) const {
+    uint64_t key = chunkKey(chunkRow, chunkCol);
+    Rng rng(seed ^ splitmix64(key));
+    std::fill(mines, mines + CHUNK_CELLS, 0);
+    for (int j = CHUNK_CELLS - minesPerChunk; j < CHUNK_CELLS; ++j) {
+        int candidate = static_cast<int>(rng.below(j + 1));
+        mines[mines[candidate] ? j : candidate] = 1;
+    }
+    if (chunkRow < -1 || chunkRow > 0 || chunkCol < -1 || chunkCol > 0) return;
+    for (int r = -1; r <= 1; ++r) {
+        for (int c = -1; c <= 1; ++c) {
+            if (chunkOf(r) != chunkRow || chunkOf(c) != chunkCol) continue;
+            mines[(r - chunkRow * CHUNK_SIZE) * CHUNK_SIZE + (c - chunkCol * CHUNK_SIZE)] = 0;
+        }
+    }
+}
+
+// Counts need the mines one cell into each neighbouring chunk, so those
+// are placed too, into a grid padded by one cell all round.
+void EndlessBoard::generate(int chunkRow, int chunkCol, Chunk& chunk) const {
+    const int padded = CHUNK_SIZE + 2;
+    uint8_t grid[padded * padded] = {};
+    uint8_t mines[CHUNK_CELLS];
+    for (int dr = -1; dr <= 1; ++dr) {
+        for (int dc = -1; dc <= 1; ++dc) {
+            placeMines(chunkRow + dr, chunkCol + dc, mines);
+            for (int r = 0; r < CHUNK_SIZE; ++r) {
+                int gridRow = r + dr * CHUNK_SIZE + 1;
+                if (gridRow < 0 || gridRow >= padded) continue;
+                for (int c = 0; c < CHUNK_SIZE; ++c) {
+                    int gridCol = c + dc * CHUNK_SIZE + 1;
+                    if (gridCol >= 0 && gridCol < padded) grid[gridRow * padded + gridCol] = mines[r * CHUNK_SIZE + c];
+                }
+            }
+        }
+    }
+    for (int r = 0; r < CHUNK_SIZE; ++r) {
+        for (int c = 0; c < CHUNK_SIZE; ++c) {
+            const uint8_t* above = &grid[r * padded + c];
+            const uint8_t* middle = above + padded;
+            const uint8_t* below = middle + padded;
+            int count = above[0] + above[1] + above[2] + middle[0] + middle[2] + below[0] + below[1] + below[2];
+            chunk.cells[r * CHUNK_SIZE + c] = static_cast<uint8_t>(middle[1] | count << COUNT_SHIFT);
+        }
+    }
+    chunk.modified = false;
+}
+
+// The loaded chunk holding the cell, read back from the cache if it was
+// evicted, or generated if create is set. nullptr if there is none.
+EndlessBoard::Chunk* EndlessBoard::findChunk(int row, int col, bool create) {
+    int chunkRow = chunkOf(row);
+    int chunkCol = chunkOf(col);
+    uint64_t key = chunkKey(chunkRow, chunkCol);
+    if (lastChunk && key == lastKey) return lastChunk;
+
+    auto found = chunks.find(key);
+    if (found == chunks.end()) {
+        bool cached = cacheIndex.count(key) != 0;
+        if (not cached && not create) return nullptr;
+        // Make room first, so a query never leaves more than maxLoaded.
+        if (not moving) trim(maxLoaded - 1);
+        Chunk& chunk = chunks[key];
+        if (not cached || !readFromCache(key, chunk)) generate(chunkRow, chunkCol, chunk);
+        recentlyUsed.push_front(key);
+        chunk.recent = recentlyUsed.begin();
+        found = chunks.find(key);
+    } else {
+        recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, found->second.recent);
+    }
+    lastKey = key;
+    lastChunk = &found->second;
+    return lastChunk;
+}
+
+uint8_t* EndlessBoard::cellAt(int row, int col, bool create) {
+    Chunk* chunk = findChunk(row, col, create);
+    if (!chunk) return nullptr;
+    int localRow = row - chunkOf(row) * CHUNK_SIZE;
+    int localCol = col - chunkOf(col) * CHUNK_SIZE;
+    return &chunk->cells[localRow * CHUNK_SIZE + localCol];
+}
+
+bool EndlessBoard::writeToCache(uint64_t key, const Chunk& chunk) {
+    if (!cache) return false;
+    std::string payload;
+    ByteWriter writer(payload);
+    writer.u64(key);
+    for (uint8_t bit : {REVEALED, FLAGGED}) {
+        for (int i = 0; i < CHUNK_CELLS; i += 8) {
+            uint8_t byte = 0;
+            for (int j = 0; j < 8; ++j) {
+                if (chunk.cells[i + j] & bit) byte |= 1 << j;
+            }
+            writer.u8(byte);
+        }
+    }
+    std::string record;
+    writeFramed(record, payload);
+    if (std::fseek(cache, 0, SEEK_END) != 0) return false;
+    long offset = std::ftell(cache);
+    if (offset < 0 || std::fwrite(record.data(), 1, record.size(), cache) != record.size()) return false;
+    cacheIndex[key] = offset;
+    ++cacheRecords;
+    if (cacheRecords >= MIN_COMPACT_RECORDS && cacheRecords > 2 * cacheIndex.size()) compactCache();
+    return true;
+}
+
+bool EndlessBoard::readFromCache(uint64_t key, Chunk& chunk) {
+    char record[RECORD_SIZE];
+    if (std::fseek(cache, cacheIndex[key], SEEK_SET) != 0 || std::fread(record, 1, RECORD_SIZE, cache) != RECORD_SIZE) {
+        return false;
+    }
+    ByteReader reader(record, RECORD_SIZE);
+    ByteReader payload(nullptr, 0);
+    uint64_t storedKey;
+    if (!readFramed(reader, payload) || payload.remaining() != PAYLOAD_SIZE || !payload.u64(storedKey) ||
+        storedKey != key) {
+        return false;
+    }
+    generate(static_cast<int32_t>(key >> 32), static_cast<int32_t>(key), chunk);
+    const char* bitmaps = payload.current();
+    for (int i = 0; i < CHUNK_CELLS; ++i) {
+        if (bitmaps[i / 8] & (1 << (i % 8))) chunk.cells[i] |= REVEALED;
+        if (bitmaps[BITMAP_SIZE + i / 8] & (1 << (i % 8))) chunk.cells[i] |= FLAGGED;
+    }
+    return true;
+}
+
+// Copies the latest record of each chunk to the other cache file and
+// switches to it. On failure the old file is kept as it was.
+bool EndlessBoard::compactCache() {
+    std::string compactPath = cacheFilePath == cachePath ? cachePath + ".compact" : cachePath;
+    std::FILE* compacted = std::fopen(compactPath.c_str(), "w+b");
+    if (!compacted) return false;
+    std::unordered_map<uint64_t, long> offsets;
+    char record[RECORD_SIZE];
+    for (const auto& entry : cacheIndex) {
+        long offset = std::ftell(compacted);
+        if (offset < 0 || std::fseek(cache, entry.second, SEEK_SET) != 0 ||
+            std::fread(record, 1, RECORD_SIZE, cache) != RECORD_SIZE ||
+            std::fwrite(record, 1, RECORD_SIZE, compacted) != RECORD_SIZE) {
+            std::fclose(compacted);
+            std::remove(compactPath.c_str());
+            return false;
+        }
+        offsets[entry.first] = offset;
+    }
+    std::fclose(cache);
+    std::remove(cacheFilePath.c_str());
+    cache = compacted;
+    cacheFilePath = compactPath;
+    cacheIndex.swap(offsets);
+    cacheRecords = cacheIndex.size();
+    return true;
+}
+
+// Evicts least recently used chunks down to limit. A changed chunk that
+// cannot be cached stays loaded.
+void EndlessBoard::trim(std::size_t limit) {
+    auto next = recentlyUsed.end();
+    while (chunks.size() > limit && next != recentlyUsed.begin()) {
+        --next;
+        uint64_t key = *next;
+        Chunk& chunk = chunks[key];
+        if (chunk.modified && !writeToCache(key, chunk)) continue;
+        next = recentlyUsed.erase(next);
+        chunks.erase(key);
+    }
+    lastChunk = nullptr;
+}
+
+void EndlessBoard::pushReveal(int row, int col) {
+    if (!inWorld(row, col)) return;
+    uint8_t* cell = cellAt(row, col, true);
+    if (*cell & (REVEALED | FLAGGED)) return;
+    *cell |= REVEALED;
+    lastChunk->modified = true;
+    revealStack.push_back(std::make_pair(row, col));
+}
+
+// Board::floodReveal() on world coordinates. Neighbours in other chunks
+// are pushed like any other, generating their chunk if need be, so a
+// flood only ever touches the chunks it actually opens cells in.
+void EndlessBoard::floodReveal() {
+    while (!revealStack.empty()) {
+        std::pair<int, int> current = revealStack.back();
+        revealStack.pop_back();
+        uint8_t cell = *cellAt(current.first, current.second, true);
+        if (not (cell & MINE)) ++revealed;
+        if ((cell >> COUNT_SHIFT) != 0 || (cell & MINE)) continue;
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                pushReveal(current.first + dr, current.second + dc);
+            }
+        }
+    }
+}
+
+// Shows every mine in the loaded chunks.
+void EndlessBoard::lose() {
+    state = GameState::Lost;
+    for (auto& entry : chunks) {
+        for (uint8_t& cell : entry.second.cells) {
+            if (cell & MINE) cell |= REVEALED;
+        }
+        entry.second.modified = true;
+    }
+}
+
+void EndlessBoard::leftClick(int x, int y) {
+    if (state != GameState::Playing || !inWorld(y, x)) return;
+    moving = true;
+    uint8_t* cell = cellAt(y, x, true);
+    if (not (*cell & (REVEALED | FLAGGED))) {
+        if (*cell & MINE) {
+            lose();
+        } else {
+            pushReveal(y, x);
+            floodReveal();
+        }
+    }
+    moving = false;
+    trim(maxLoaded);
+}
+
+void EndlessBoard::chord(int x, int y) {
+    if (state != GameState::Playing || !inWorld(y, x)) return;
+    moving = true;
+    uint8_t cell = *cellAt(y, x, true);
+    int number = cell >> COUNT_SHIFT;
+    if ((cell & REVEALED) && not (cell & MINE) && number > 0) {
+        int flags = 0;
+        bool hitMine = false;
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                uint8_t neighbour = *cellAt(y + dr, x + dc, true);
+                if (neighbour & FLAGGED) ++flags;
+                else if (not (neighbour & REVEALED) && (neighbour & MINE)) hitMine = true;
+            }
+        }
+        if (flags == number) {
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    pushReveal(y + dr, x + dc);
+                }
+            }
+            floodReveal();
+            if (hitMine) lose();
+        }
+    }
+    moving = false;
+    trim(maxLoaded);
+}
+
+void EndlessBoard::rightClick(int x, int y) {
+    if (state != GameState::Playing || !inWorld(y, x)) return;
+    moving = true;
+    uint8_t* cell = cellAt(y, x, true);
+    if (not (*cell & REVEALED)) {
+        *cell ^= FLAGGED;
+        flagsPlaced += (*cell & FLAGGED) ? 1 : -1;
+        lastChunk->modified = true;
+    }
+    moving = false;
+    trim(maxLoaded);
+}
+
+TileState EndlessBoard::getTileState(int row, int col) {
+    const uint8_t* cell = inWorld(row, col) ? cellAt(row, col, false) : nullptr;
+    if (!cell) return TileState::Hidden;
+    if (*cell & REVEALED) return TileState::Revealed;
+    if (*cell & FLAGGED) return TileState::Flagged;
+    return TileState::Hidden;
+}
+
+bool EndlessBoard::hasMine(int row, int col) {
+    const uint8_t* cell = inWorld(row, col) ? cellAt(row, col, false) : nullptr;
+    return cell && (*cell & MINE);
+}
+
+int EndlessBoard::getAdjacentMines(int row, int col) {
+    const uint8_t* cell = inWorld(row, col) ? cellAt(row, col, false) : nullptr;
+    return cell ? *cell >> COUNT_SHIFT : 0;
+}
+
+GameState EndlessBoard::getGameState() const {
+    return state;
+}
+
+long long EndlessBoard::getRevealedCount() const {
+    return revealed;
+}
+
+long long EndlessBoard::getFlagCount() const {
+    return flagsPlaced;
+}
+
+uint64_t EndlessBoard::getSeed() const {
+    return seed;
+}
+
+std::size_t EndlessBoard::loadedChunkCount() const {
+    return chunks.size();
+}
+
+std::size_t EndlessBoard::cachedChunkCount() const {
+    return cacheIndex.size();
+}
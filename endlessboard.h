@@ -0,0 +1,109 @@
+#ifndef MINESWEEPER_ENDLESSBOARD_H
+#define MINESWEEPER_ENDLESSBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "board.h"
+
+// A minefield without edges, split into square chunks. A chunk's mines
+// follow from a hash of the seed and its coordinate, so chunks are only
+// generated once a move reaches them and the untouched world costs
+// nothing. Between moves at most maxLoaded chunks stay in memory: the
+// least recently used are dropped, and those with opened or flagged cells
+// are first appended to a scratch cache file as two bitmaps, to be read
+// back when next needed. Once superseded records outnumber the live ones
+// the cache is copied, live records only, to a fresh file. The cells around (0, 0) never hold a mine, so
+// opening it starts a game. There is no win, only a count of opened cells.
+class EndlessBoard {
+public:
+    static const int CHUNK_SIZE = 32;
+    // Coordinates stay within +-WORLD_LIMIT so neighbours never overflow.
+    static const int WORLD_LIMIT = 1 << 30;
+
+private:
+    static const int CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+    // Same cell encoding as Board.
+    static const uint8_t MINE = 1 << 0;
+    static const uint8_t REVEALED = 1 << 1;
+    static const uint8_t FLAGGED = 1 << 2;
+    static const int COUNT_SHIFT = 4;
+
+    struct Chunk {
+        uint8_t cells[CHUNK_CELLS];
+        // Changed since it was generated or last read from the cache.
+        bool modified = false;
+        std::list<uint64_t>::iterator recent;
+    };
+
+    uint64_t seed;
+    int minesPerChunk;
+    std::size_t maxLoaded;
+    std::string cachePath;
+    // Compaction alternates between cachePath and cachePath + ".compact".
+    std::string cacheFilePath;
+    std::FILE* cache = nullptr;
+    // Records in the cache file, superseded ones included.
+    std::size_t cacheRecords = 0;
+    std::unordered_map<uint64_t, Chunk> chunks;
+    // Loaded chunks, most recently used first.
+    std::list<uint64_t> recentlyUsed;
+    // Offset of each cached chunk's latest record.
+    std::unordered_map<uint64_t, long> cacheIndex;
+    std::vector<std::pair<int, int>> revealStack;
+    uint64_t lastKey = 0;
+    Chunk* lastChunk = nullptr;
+    // Set during a move so no chunk it is working on gets evicted.
+    bool moving = false;
+    GameState state = GameState::Playing;
+    long long revealed = 0;
+    long long flagsPlaced = 0;
+
+    static uint64_t chunkKey(int chunkRow, int chunkCol);
+    static int chunkOf(int coordinate);
+    static bool inWorld(int row, int col);
+    void placeMines(int chunkRow, int chunkCol, uint8_t* mines) const;
+    void generate(int chunkRow, int chunkCol, Chunk& chunk) const;
+    Chunk* findChunk(int row, int col, bool create);
+    uint8_t* cellAt(int row, int col, bool create);
+    bool writeToCache(uint64_t key, const Chunk& chunk);
+    bool readFromCache(uint64_t key, Chunk& chunk);
+    bool compactCache();
+    void trim(std::size_t limit);
+    void pushReveal(int row, int col);
+    void floodReveal();
+    void lose();
+public:
+    // minesPerChunk is raised to an eighth of a chunk if lower: below about
+    // a tenth, empty regions stop being finite and one click could flood
+    // without end.
+    EndlessBoard(uint64_t seed, int minesPerChunk, const std::string& cachePath, std::size_t maxLoadedChunks = 1024);
+    ~EndlessBoard();
+    EndlessBoard(const EndlessBoard&) = delete;
+    EndlessBoard& operator=(const EndlessBoard&) = delete;
+
+    // Moves as on Board, x being the column and y the row.
+    void leftClick(int x, int y);
+    void chord(int x, int y);
+    void rightClick(int x, int y);
+
+    // Queries read evicted chunks back from the cache but never generate
+    // one: a cell no move has reached is hidden.
+    TileState getTileState(int row, int col);
+    bool hasMine(int row, int col);
+    int getAdjacentMines(int row, int col);
+
+    GameState getGameState() const;
+    long long getRevealedCount() const;
+    long long getFlagCount() const;
+    uint64_t getSeed() const;
+    std::size_t loadedChunkCount() const;
+    std::size_t cachedChunkCount() const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef MINESWEEPER_GAMECLOCK_H
+#define MINESWEEPER_GAMECLOCK_H
+
+#include <chrono>
+
+// Game timer on a monotonic clock, kept independently of how often frames
+// are drawn. Time only accumulates between start() and pause().
+class GameClock {
+private:
+    typedef std::chrono::steady_clock clock;
+    clock::duration accumulated = clock::duration::zero();
+    clock::time_point startedAt;
+    bool running = false;
+
+public:
+    void start() {
+        if (running) return;
+        startedAt = clock::now();
+        running = true;
+    }
+
+    void pause() {
+        if (not running) return;
+        accumulated += clock::now() - startedAt;
+        running = false;
+    }
+
+    void reset() {
+        accumulated = clock::duration::zero();
+        running = false;
+    }
+
+    // Stopped at the given time, as when resuming a saved game.
+    void restore(long long milliseconds) {
+        accumulated = std::chrono::duration_cast<clock::duration>(std::chrono::milliseconds(milliseconds));
+        running = false;
+    }
+
+    bool isRunning() const {
+        return running;
+    }
+
+    long long elapsedMilliseconds() const {
+        clock::duration total = accumulated;
+        if (running) total += clock::now() - startedAt;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(total).count();
+    }
+
+    int elapsedSeconds() const {
+        return static_cast<int>(elapsedMilliseconds() / 1000);
+    }
+
+    int millisecondsToNextSecond() const {
+        return static_cast<int>(1000 - elapsedMilliseconds() % 1000);
+    }
+};
+
+#endif
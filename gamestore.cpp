@@ -0,0 +1,205 @@
+#include "gamestore.h"
+#include <cctype>
+#include <cerrno>
+#include <fstream>
+#include "binaryio.h"
+
+// Log layout, little-endian: "MSWL", u32 version, then per record
+//   u32 payload length, payload, u32 checksum32(payload)
+// where the payload is
+//   u32 rows, u32 columns, u32 mines, u64 seed, u64 time in ms,
+//   u8 outcome, u64 finishedAt, u32 name length, name.
+static const char LOG_MAGIC[] = "MSWL";
+static const std::size_t HEADER_SIZE = 8;
+static const std::size_t MAX_NAME_LENGTH = 1024;
+
+static std::string logHeader() {
+    std::string header(LOG_MAGIC, 4);
+    ByteWriter(header).u32(GameStore::LOG_VERSION);
+    return header;
+}
+
+static void encodeRecord(const GameRecord& record, std::string& out) {
+    std::string payload;
+    ByteWriter fields(payload);
+    fields.u32(static_cast<uint32_t>(record.config.rows));
+    fields.u32(static_cast<uint32_t>(record.config.columns));
+    fields.u32(static_cast<uint32_t>(record.config.mines));
+    fields.u64(record.seed);
+    fields.u64(record.timeMs);
+    fields.u8(static_cast<uint8_t>(record.outcome));
+    fields.u64(static_cast<uint64_t>(record.finishedAt));
+    fields.text(record.player);
+
+    writeFramed(out, payload);
+}
+
+static bool decodeRecord(ByteReader& reader, GameRecord& record) {
+    uint32_t rows, columns, mines;
+    uint8_t outcome;
+    uint64_t finishedAt;
+    ByteReader fields(nullptr, 0);
+    if (!readFramed(reader, fields)) return false;
+
+    if (!fields.u32(rows) || !fields.u32(columns) || !fields.u32(mines) || !fields.u64(record.seed) ||
+        !fields.u64(record.timeMs) || !fields.u8(outcome) || !fields.u64(finishedAt) ||
+        !fields.text(record.player, MAX_NAME_LENGTH) || outcome > static_cast<uint8_t>(GameOutcome::Abandoned)) {
+        return false;
+    }
+    record.config = BoardConfig{static_cast<int>(rows), static_cast<int>(columns), static_cast<int>(mines)};
+    record.outcome = static_cast<GameOutcome>(outcome);
+    record.finishedAt = static_cast<int64_t>(finishedAt);
+    return true;
+}
+
+GameStore::~GameStore() {
+    if (log) std::fclose(log);
+}
+
+void GameStore::index(uint32_t id) {
+    const GameRecord& record = records[id];
+    byPlayer[record.player].push_back(id);
+    if (record.outcome != GameOutcome::Won) return;
+    std::pair<uint64_t, uint32_t> entry(record.timeMs, id);
+    byConfig[record.config].insert(entry);
+    byPlayerConfig[std::make_pair(record.player, record.config)].insert(entry);
+}
+
+bool GameStore::openForAppend() {
+    if (log) std::fclose(log);
+    log = std::fopen(path.c_str(), "ab");
+    return log != nullptr;
+}
+
+bool GameStore::open(const std::string& logPath) {
+    path = logPath;
+    std::vector<char> contents;
+    if (!readWholeFile(path, contents)) {
+        // Only start a new log when there is none, never over one we could not read.
+        errno = 0;
+        std::FILE* existing = std::fopen(path.c_str(), "rb");
+        if (existing) std::fclose(existing);
+        if (existing || errno != ENOENT) return false;
+    }
+    if (contents.empty()) {
+        return writeFileAtomically(path, logHeader()) && openForAppend();
+    }
+    bool damaged;
+    if (!load(contents, damaged)) return false;
+    // A record torn by a crash or a damaged tail is dropped by rewriting.
+    if (damaged) return compact();
+    return openForAppend();
+}
+
+bool GameStore::openReadOnly(const std::string& logPath, bool& damaged) {
+    path = logPath;
+    std::vector<char> contents;
+    damaged = false;
+    return readWholeFile(path, contents) && load(contents, damaged);
+}
+
+// Indexes every intact record; damaged is set if anything is left over.
+bool GameStore::load(const std::vector<char>& contents, bool& damaged) {
+    if (contents.size() < HEADER_SIZE || std::string(contents.data(), HEADER_SIZE) != logHeader()) {
+        // Not our log, or a version we do not understand: leave it alone.
+        return false;
+    }
+    ByteReader reader(contents.data() + HEADER_SIZE, contents.size() - HEADER_SIZE);
+    GameRecord record;
+    while (reader.remaining() > 0 && decodeRecord(reader, record)) {
+        records.push_back(record);
+        index(static_cast<uint32_t>(records.size() - 1));
+    }
+    damaged = reader.remaining() > 0;
+    return true;
+}
+
+bool GameStore::append(const GameRecord& record, uint32_t& id) {
+    records.push_back(record);
+    id = static_cast<uint32_t>(records.size() - 1);
+    index(id);
+    if (!log) return false;
+
+    // Records appended behind a torn one could never be read back, so the
+    // log is rewritten from memory instead, this record included.
+    if (!torn) {
+        std::string encoded;
+        encodeRecord(record, encoded);
+        if (std::fwrite(encoded.data(), 1, encoded.size(), log) == encoded.size() && syncFile(log)) return true;
+    }
+    torn = !compact();
+    return !torn;
+}
+
+bool GameStore::compact() {
+    std::string contents = logHeader();
+    for (const GameRecord& record : records) {
+        encodeRecord(record, contents);
+    }
+    // Windows cannot replace a file that is still open.
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+    bool written = writeFileAtomically(path, contents);
+    return openForAppend() && written;
+}
+
+int GameStore::importLegacyLeaderboard(const std::string& legacyPath, const BoardConfig& config) {
+    std::ifstream legacy(legacyPath);
+    std::string line;
+    int imported = 0;
+    while (std::getline(legacy, line)) {
+        // "MM:SS, name"; anything else is skipped.
+        std::size_t colon = line.find(':');
+        std::size_t comma = line.find(',', colon == std::string::npos ? 0 : colon);
+        if (colon == std::string::npos || comma == std::string::npos || colon == 0 || comma == colon + 1) continue;
+        bool digits = true;
+        for (std::size_t i = 0; i < comma; ++i) {
+            if (i != colon && not std::isdigit(static_cast<unsigned char>(line[i]))) digits = false;
+        }
+        if (not digits || colon > 6 || comma - colon > 3) continue;
+        uint64_t seconds = std::stoull(line.substr(0, colon)) * 60 + std::stoull(line.substr(colon + 1, comma - colon - 1));
+        std::size_t nameStart = line.find_first_not_of(' ', comma + 1);
+        std::string name = nameStart == std::string::npos ? "" : line.substr(nameStart);
+        if (!name.empty() && name.back() == '\r') name.pop_back();
+
+        uint32_t id;
+        append(GameRecord{name, config, 0, seconds * 1000, GameOutcome::Won, 0}, id);
+        ++imported;
+    }
+    return imported;
+}
+
+std::size_t GameStore::size() const {
+    return records.size();
+}
+
+const GameRecord& GameStore::record(uint32_t id) const {
+    return records[id];
+}
+
+std::vector<uint32_t> GameStore::topOf(const Ranking& ranking, std::size_t k) {
+    std::vector<uint32_t> ids;
+    for (auto it = ranking.begin(); it != ranking.end() && ids.size() < k; ++it) {
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+std::vector<uint32_t> GameStore::topTimes(const BoardConfig& config, std::size_t k) const {
+    auto found = byConfig.find(config);
+    return found == byConfig.end() ? std::vector<uint32_t>() : topOf(found->second, k);
+}
+
+std::vector<uint32_t> GameStore::playerTopTimes(const std::string& player, const BoardConfig& config,
+                                                std::size_t k) const {
+    auto found = byPlayerConfig.find(std::make_pair(player, config));
+    return found == byPlayerConfig.end() ? std::vector<uint32_t>() : topOf(found->second, k);
+}
+
+const std::vector<uint32_t>& GameStore::playerGames(const std::string& player) const {
+    static const std::vector<uint32_t> none;
+    auto found = byPlayer.find(player);
+    return found == byPlayer.end() ? none : found->second;
+}
@@ -0,0 +1,100 @@
+#ifndef MINESWEEPER_GAMESTORE_H
+#define MINESWEEPER_GAMESTORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct BoardConfig {
+    int rows;
+    int columns;
+    int mines;
+
+    bool operator<(const BoardConfig& other) const {
+        if (rows != other.rows) return rows < other.rows;
+        if (columns != other.columns) return columns < other.columns;
+        return mines < other.mines;
+    }
+};
+
+enum class GameOutcome : uint8_t {
+    Won,
+    Lost,
+    Abandoned,
+};
+
+struct GameRecord {
+    std::string player;
+    BoardConfig config;
+    uint64_t seed;
+    uint64_t timeMs;
+    GameOutcome outcome;
+    // Seconds since the Unix epoch; 0 for games imported from leaderboard.txt.
+    int64_t finishedAt;
+};
+
+// Every finished game, kept in an append-only log file and indexed in
+// memory. Each record is written with its length and a checksum in one
+// write and synced, so a crash can at worst lose the record being written;
+// open() drops a torn tail and compacts the log. A write that fails part way
+// is repaired the same way before anything else is appended. Compaction
+// rewrites the log beside the original and renames it into place.
+//
+// Won games are ranked per board config and per player and config in
+// ordered sets, so a top-K query costs O(K) whatever the history size.
+// Records are identified by their position in the log.
+class GameStore {
+private:
+    typedef std::set<std::pair<uint64_t, uint32_t>> Ranking;
+
+    std::string path;
+    std::FILE* log = nullptr;
+    // A failed write may have left part of a record at the end of the log.
+    bool torn = false;
+    std::vector<GameRecord> records;
+    std::map<BoardConfig, Ranking> byConfig;
+    std::map<std::pair<std::string, BoardConfig>, Ranking> byPlayerConfig;
+    std::unordered_map<std::string, std::vector<uint32_t>> byPlayer;
+
+    void index(uint32_t id);
+    bool load(const std::vector<char>& contents, bool& damaged);
+    bool openForAppend();
+    static std::vector<uint32_t> topOf(const Ranking& ranking, std::size_t k);
+public:
+    static const uint32_t LOG_VERSION = 1;
+
+    GameStore() = default;
+    ~GameStore();
+    GameStore(const GameStore&) = delete;
+    GameStore& operator=(const GameStore&) = delete;
+
+    // Loads the log at path, creating it if missing. Returns false if the
+    // file cannot be read or written; the in-memory store still works.
+    bool open(const std::string& logPath);
+    // Loads the log without ever writing to it, for tools that inspect one.
+    // damaged is set when a torn or corrupted record ended the read early.
+    // Appends are kept in memory only.
+    bool openReadOnly(const std::string& logPath, bool& damaged);
+    // Records a finished game and returns its id. Returns false if it could
+    // not be written to disk; it is still indexed.
+    bool append(const GameRecord& record, uint32_t& id);
+    bool compact();
+    // Reads the old five-line "MM:SS, name" leaderboard as won games on
+    // config, skipping lines it cannot parse. Returns how many it imported.
+    int importLegacyLeaderboard(const std::string& legacyPath, const BoardConfig& config);
+
+    std::size_t size() const;
+    const GameRecord& record(uint32_t id) const;
+    // Ids of the k fastest wins, fastest first.
+    std::vector<uint32_t> topTimes(const BoardConfig& config, std::size_t k) const;
+    std::vector<uint32_t> playerTopTimes(const std::string& player, const BoardConfig& config, std::size_t k) const;
+    // Ids of every game the player finished, oldest first.
+    const std::vector<uint32_t>& playerGames(const std::string& player) const;
+};
+
+#endif
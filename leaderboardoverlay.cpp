@@ -0,0 +1,55 @@
+#include "leaderboardoverlay.h"
+
+static void centerText(sf::Text& text, float x, float y) {
+    sf::FloatRect textRect = text.getLocalBounds();
+    text.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
+    text.setPosition(sf::Vector2f(x, y));
+}
+
+LeaderboardOverlay::LeaderboardOverlay(const sf::Font& font, float boardWidth, float boardHeight)
+        : title("LEADERBOARD", font, 20), entries("", font, 18) {
+    sf::Vector2f size(boardWidth / 2.0f, boardHeight / 2.0f + 50);
+    panel.setSize(size);
+    panel.setFillColor(sf::Color::Blue);
+    panel.setPosition((boardWidth - size.x) / 2.0f, (boardHeight - size.y) / 2.0f);
+
+    title.setFillColor(sf::Color::White);
+    title.setStyle(sf::Text::Bold | sf::Text::Underlined);
+    centerText(title, boardWidth / 2.0f, boardHeight / 2.0f - 120);
+
+    entries.setFillColor(sf::Color::White);
+    entries.setStyle(sf::Text::Bold);
+}
+
+void LeaderboardOverlay::setEntries(const std::vector<int>& times, const std::vector<std::string>& names,
+                                    int highlight) {
+    if (laidOut && times == shownTimes && names == shownNames && highlight == shownHighlight) return;
+    shownTimes = times;
+    shownNames = names;
+    shownHighlight = highlight;
+    laidOut = true;
+
+    std::string display_txt = "";
+    for (std::size_t i = 0; i < times.size(); ++i){
+        display_txt += std::to_string(i + 1) + ".\t";
+        if (times[i]/60 < 10) display_txt += "0";
+        display_txt += std::to_string(times[i]/60) + ":";
+        if (times[i]%60 < 10) display_txt += "0";
+        display_txt += std::to_string(times[i]%60) + "\t" + names[i];
+
+        if (highlight == static_cast<int>(i)){
+            display_txt += "*";
+        }
+        display_txt += "\n\n";
+    }
+
+    entries.setString(display_txt);
+    sf::Vector2f center = panel.getPosition() + panel.getSize() / 2.0f;
+    centerText(entries, center.x, center.y + 20);
+}
+
+void LeaderboardOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(panel, states);
+    target.draw(title, states);
+    target.draw(entries, states);
+}
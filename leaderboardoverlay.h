@@ -0,0 +1,31 @@
+#ifndef MINESWEEPER_LEADERBOARDOVERLAY_H
+#define MINESWEEPER_LEADERBOARDOVERLAY_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+// The leaderboard drawn as a panel over the board inside the game window.
+// Its text is laid out once per change of entries, so opening, closing and
+// redrawing it only issue a few draw calls.
+class LeaderboardOverlay : public sf::Drawable {
+private:
+    sf::RectangleShape panel;
+    sf::Text title;
+    sf::Text entries;
+    std::vector<int> shownTimes;
+    std::vector<std::string> shownNames;
+    int shownHighlight = -1;
+    bool laidOut = false;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+public:
+    // Centres a panel the size of the old leaderboard window over a board
+    // of boardWidth x boardHeight pixels.
+    LeaderboardOverlay(const sf::Font& font, float boardWidth, float boardHeight);
+    // Times are in whole seconds; highlight is the entry to star, or -1.
+    // Does nothing if the entries are the ones already shown.
+    void setEntries(const std::vector<int>& times, const std::vector<std::string>& names, int highlight);
+};
+
+#endif
@@ -1,10 +1,41 @@
 #include <iostream>
 #include <fstream>
-#include <chrono>
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <memory>
 #include <SFML/Graphics.hpp>
+#include "assetcache.h"
 #include "board.h"
+#include "boardpool.h"
 #include "button.h"
+#include "camera.h"
+#include "endlessboard.h"
+#include "gameclock.h"
+#include "gamestore.h"
+#include "leaderboardoverlay.h"
+#include "noguess.h"
+#include "probability.h"
+#include "profiler.h"
+#include "profileroverlay.h"
+#include "replay.h"
+#include "savegame.h"
+#include "threadpool.h"
+#include "tilemap.h"
+
+// Redraws are event driven, this only caps bursts of them.
+const unsigned FRAME_LIMIT = 60;
+
+const char* const REPLAY_LOG = "photos/files/replays.log";
+// An unfinished game is saved this often, on pause and on exit.
+const char* const SAVE_FILE = "photos/files/game.save";
+const int AUTOSAVE_SECONDS = 10;
+// F4 writes the profiler's recent frames here.
+const char* const TRACE_FILE = "photos/files/trace.json";
+// Playback speeds stepped through with + and - while watching a replay.
+const int REPLAY_SPEEDS[] = {1, 2, 5, 10, 25, 50, 100};
 
 void setText(sf::Text &text, float x, float y) {
     sf::FloatRect textRect = text.getLocalBounds();
@@ -12,8 +43,32 @@ void setText(sf::Text &text, float x, float y) {
     text.setPosition(sf::Vector2f(x, y));
 }
 
+// SFML 2.5's waitEvent cannot time out, so sleep in short slices between
+// polls until an event arrives or the timeout passes.
+bool waitEventFor(sf::RenderWindow& window, sf::Event& event, sf::Time timeout) {
+    sf::Clock waited;
+    while (!window.pollEvent(event)) {
+        sf::Time remaining = timeout - waited.getElapsedTime();
+        if (remaining <= sf::Time::Zero) return false;
+        sf::sleep(std::min(remaining, sf::milliseconds(4)));
+    }
+    return true;
+}
 
-bool readConfigFile(const std::string& filename, int& columns, int& rows, int& numMines) {
+// The title bar carries the board seed so a game can be shared or reported.
+std::string windowTitle(const Board& board) {
+    std::ostringstream title;
+    title << "Game Window - seed " << std::hex << std::setw(16) << std::setfill('0') << board.getSeed();
+    return title.str();
+}
+
+// Columns, rows and mines, one per line, then two optional lines: the
+// mode, 1 to generate only boards that can be solved without guessing or
+// 2 for an endless board seen through a window of that size and mine
+// density, and a board seed in hex to replay a particular game (as shown
+// in the title bar).
+bool readConfigFile(const std::string& filename, int& columns, int& rows, int& numMines, bool& noGuess,
+                    bool& endless, bool& hasSeed, uint64_t& seed) {
     std::ifstream configFile(filename);
     if (!configFile.is_open()) {
         std::cerr << "Failed to open configuration file: " << filename << std::endl;
@@ -39,6 +94,20 @@ bool readConfigFile(const std::string& filename, int& columns, int& rows, int& n
                 std::cerr << "Invalid number of mines" << std::endl;
                 return false;
             }
+        } else if (lineCount == 3) {
+            int mode;
+            if (!(iss >> mode) || mode < 0 || mode > 2) {
+                std::cerr << "Invalid mode, expected 0, 1 (no-guess) or 2 (endless)" << std::endl;
+                return false;
+            }
+            noGuess = mode == 1;
+            endless = mode == 2;
+        } else if (lineCount == 4) {
+            if (!(iss >> std::hex >> seed)) {
+                std::cerr << "Invalid board seed" << std::endl;
+                return false;
+            }
+            hasSeed = true;
         } else {
             std::cerr << "Invalid number of lines in configuration file" << std::endl;
             return false;
@@ -55,50 +124,30 @@ bool readConfigFile(const std::string& filename, int& columns, int& rows, int& n
     return true;
 }
 
-bool readLeaderboardFile(const std::string& filename, std::vector<int>& times, std::vector<std::string>& names){
-    std::ifstream leaderboardfile(filename);
-    if (!leaderboardfile.is_open()){
-        return false;
-    }
-    std::string leaderboardline;
-    for (int i = 0; i < 5; ++i){
-        std::getline(leaderboardfile, leaderboardline);
-        int time = stoi(leaderboardline.substr(0,2)) * 60 + stoi(leaderboardline.substr(3,2));
-        times.push_back(time);
-        names.push_back(leaderboardline.substr(7));
+// The five fastest wins on this board size, as whole seconds and names for
+// the leaderboard window. highlightId marks the entry to star, if present.
+void loadLeaderboard(const GameStore& store, const BoardConfig& config, std::vector<int>& times,
+                     std::vector<std::string>& names, int& highlight, long highlightId){
+    times.clear();
+    names.clear();
+    highlight = -1;
+    for (uint32_t id : store.topTimes(config, 5)){
+        if (id == highlightId) highlight = static_cast<int>(times.size());
+        times.push_back(static_cast<int>(store.record(id).timeMs / 1000));
+        names.push_back(store.record(id).player);
     }
-    leaderboardfile.close();
-    return true;
 }
 
-bool writeLeaderboardFile(const std::string& filename, std::vector<int>& times, std::vector<std::string>& names){
-    std::ofstream leaderboardfile(filename);
-    if (!leaderboardfile.is_open()) return false;
-    for (int i = 0; i < 5; ++i){
-        std::string writeline = "";
-        if (times[i]/60 < 10) writeline += "0";
-        writeline += std::to_string(times[i]/60) + ":";
-        if (times[i]%60 < 10) writeline += "0";
-        writeline += std::to_string(times[i]%60) + ", " + names[i];
-        writeline += "\n";
+// Larger boards are seen through a camera that zooms and pans.
+const int MAX_FIELD_WIDTH = 1280;
+const int MAX_FIELD_HEIGHT = 800;
 
-
-        leaderboardfile << writeline;
-    }
-    leaderboardfile.close();
-    return true;
-}
-
-std::string showWelcomeWindow(int row, int col) {
-    int windowWidth = col * 32 + 100;
-    int windowHeight = row * 32 + 100;
+std::string showWelcomeWindow(int row, int col, const sf::Font& font) {
+    int windowWidth = std::min(col * 32, MAX_FIELD_WIDTH) + 100;
+    int windowHeight = std::min(row * 32, MAX_FIELD_HEIGHT) + 100;
     sf::RenderWindow welcomeWindow(sf::VideoMode(windowWidth, windowHeight), "Welcome Window");
 
     int maxNameLength = 10;
-    sf::Font font;
-    if (!font.loadFromFile("photos/files/font.ttf")) {
-        std::cout << "Failed to load font file!" << std::endl;
-    }
     sf::Text welcome("WELCOME TO MINESWEEPER!", font, 24);
     welcome.setFillColor(sf::Color::White);
     welcome.setStyle(sf::Text::Bold | sf::Text::Underlined);
@@ -118,7 +167,8 @@ std::string showWelcomeWindow(int row, int col) {
 
     while (welcomeWindow.isOpen()) {
         sf::Event event;
-        while (welcomeWindow.pollEvent(event)) {
+        bool hasEvent = waitEventFor(welcomeWindow, event, sf::seconds(0.5f) - cursorClock.getElapsedTime());
+        for (; hasEvent; hasEvent = welcomeWindow.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 welcomeWindow.close();
                 return "0";
@@ -162,222 +212,527 @@ std::string showWelcomeWindow(int row, int col) {
     return playerName;
 }
 
-void showLeaderboardWindow(int row, int col, std::vector<int>& times, std::vector<std::string>& names, bool& isopen, int new_winner){
-    int windowWidth = col * 16;
-    int windowHeight = row * 16 + 50;
-    sf::RenderWindow leaderboard(sf::VideoMode(windowWidth, windowHeight), "Leaderboard");
-    sf::Font font;
-    if (!font.loadFromFile("photos/files/font.ttf")) {
-        std::cout << "Failed to load font file!" << std::endl;
-    }
-
-    std::string display_txt = "";
-
-    for (int i = 0; i < 5; ++i){
-        display_txt += std::to_string(i + 1) + ".\t";
-        if (times[i]/60 < 10) display_txt += "0";
-        display_txt += std::to_string(times[i]/60) + ":";
-        if (times[i]%60 < 10) display_txt += "0";
-        display_txt += std::to_string(times[i]%60) + "\t" + names[i];
-
-        if (new_winner == i){
-            display_txt += "*";
+// Endless mode: the window shows a rows x columns view onto an endless
+// board, starting around its always-safe origin. The arrow keys scroll a
+// quarter of the view at a time; after a loss, Space starts a new world.
+int playEndless(sf::RenderWindow& window, const TileAtlas& atlas, int rows, int columns, int numMines, uint64_t seed) {
+    // The configured board's density, per chunk.
+    int minesPerChunk = static_cast<int>(static_cast<long long>(numMines) * EndlessBoard::CHUNK_SIZE *
+                                         EndlessBoard::CHUNK_SIZE / (static_cast<long long>(rows) * columns));
+    std::unique_ptr<EndlessBoard> board(new EndlessBoard(seed, minesPerChunk, "photos/files/endless.cache"));
+    rows = std::min(rows, MAX_FIELD_HEIGHT / 32);
+    columns = std::min(columns, MAX_FIELD_WIDTH / 32);
+    int top = -rows / 2;
+    int left = -columns / 2;
+    TileMap tilemap(atlas);
+    tilemap.resize(rows, columns, 32.0f);
+
+    bool redraw = true;
+    while (window.isOpen()) {
+        if (redraw) {
+            redraw = false;
+            tilemap.update(*board, top, left);
+            window.clear(sf::Color::White);
+            window.draw(tilemap);
+            window.display();
+            std::ostringstream title;
+            title << "Endless - seed " << std::hex << std::setw(16) << std::setfill('0') << board->getSeed() << std::dec
+                  << " - " << board->getRevealedCount() << " opened"
+                  << (board->getGameState() == GameState::Lost ? " - press Space" : "");
+            window.setTitle(title.str());
         }
-        display_txt += "\n\n";
-    }
 
-    sf::Text welcome("LEADERBOARD", font, 20);
-    welcome.setFillColor(sf::Color::White);
-    welcome.setStyle(sf::Text::Bold | sf::Text::Underlined);
-    setText(welcome, leaderboard.getSize().x / 2.f, leaderboard.getSize().y / 2.f - 120);
-
-    sf::Text leaderboardtxt(display_txt, font, 18);
-    leaderboardtxt.setFillColor(sf::Color::White);
-    leaderboardtxt.setStyle(sf::Text::Bold);
-    setText(leaderboardtxt, leaderboard.getSize().x / 2.f, leaderboard.getSize().y / 2.f + 20);
-
-
-    while (leaderboard.isOpen()){
-        sf::Event event1;
-        while (leaderboard.pollEvent(event1)){
-            if (event1.type == sf::Event::Closed){
-                leaderboard.close();
-                isopen = false;
-                return;
+        sf::Event event;
+        for (bool hasEvent = window.waitEvent(event); hasEvent; hasEvent = window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                window.close();
+            } else if (event.type == sf::Event::GainedFocus || event.type == sf::Event::Resized) {
+                redraw = true;
+            } else if (event.type == sf::Event::KeyPressed) {
+                redraw = true;
+                switch (event.key.code) {
+                    case sf::Keyboard::Left: left -= std::max(1, columns / 4); break;
+                    case sf::Keyboard::Right: left += std::max(1, columns / 4); break;
+                    case sf::Keyboard::Up: top -= std::max(1, rows / 4); break;
+                    case sf::Keyboard::Down: top += std::max(1, rows / 4); break;
+                    case sf::Keyboard::Space:
+                        if (board->getGameState() == GameState::Lost) {
+                            // The old board removes its cache before the new one opens it.
+                            board.reset();
+                            board.reset(new EndlessBoard(splitmix64(seed), minesPerChunk, "photos/files/endless.cache"));
+                            top = -rows / 2;
+                            left = -columns / 2;
+                        }
+                        break;
+                    default: redraw = false; break;
+                }
+                top = std::max(-EndlessBoard::WORLD_LIMIT / 2, std::min(top, EndlessBoard::WORLD_LIMIT / 2));
+                left = std::max(-EndlessBoard::WORLD_LIMIT / 2, std::min(left, EndlessBoard::WORLD_LIMIT / 2));
+            } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.y < rows * 32) {
+                redraw = true;
+                int x = left + event.mouseButton.x / 32;
+                int y = top + event.mouseButton.y / 32;
+                sf::Mouse::Button button = event.mouseButton.button;
+                bool chording = button == sf::Mouse::Middle
+                        || (button == sf::Mouse::Left && sf::Mouse::isButtonPressed(sf::Mouse::Right))
+                        || (button == sf::Mouse::Right && sf::Mouse::isButtonPressed(sf::Mouse::Left));
+                if (chording) board->chord(x, y);
+                else if (button == sf::Mouse::Left) board->leftClick(x, y);
+                else if (button == sf::Mouse::Right) board->rightClick(x, y);
             }
         }
-        leaderboard.clear(sf::Color::Blue);
-        leaderboard.draw(welcome);
-        leaderboard.draw(leaderboardtxt);
-        leaderboard.display();
     }
+    return 0;
 }
 
 int main() {
     int columns, rows, numMines;
-    if (!readConfigFile("photos/files/config.cfg", columns, rows, numMines)) {
+    bool noGuess = false;
+    bool endless = false;
+    bool hasSeed = false;
+    uint64_t seed = 0;
+    if (!readConfigFile("photos/files/config.cfg", columns, rows, numMines, noGuess, endless, hasSeed, seed)) {
         return 1;
     }
-    std::string playername = showWelcomeWindow(rows, columns);
+    // Shared by asset loading, the no-guess generator and the probability overlay.
+    ThreadPool pool;
+
+    AssetCache assets;
+    // One read of the packed bundle next to the game when it exists,
+    // otherwise the loose files decoded in parallel.
+    if (!assets.loadBundle("assets.bundle") && !assets.preload(gameImagePaths(), {GAME_FONT_PATH}, pool)) {
+        std::cerr << "Some assets failed to load" << std::endl;
+    }
+    const sf::Font& font = assets.font(GAME_FONT_PATH);
+
+    std::string playername = showWelcomeWindow(rows, columns, font);
     if (playername == "0") return 1;
 
-    int windowWidth = columns * 32;
-    int windowHeight = rows * 32 + 100;
+    int fieldWidth = std::min(columns * 32, MAX_FIELD_WIDTH);
+    int fieldHeight = std::min(rows * 32, MAX_FIELD_HEIGHT);
+    int windowWidth = fieldWidth;
+    int windowHeight = fieldHeight + 100;
 
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Game Window", sf::Style::Close);
-    auto time1 = std::chrono::high_resolution_clock::now();
-    double time_duration = 0;
+    window.setFramerateLimit(FRAME_LIMIT);
 
+    GameClock gameClock;
     int game_time = 0;
-    sf::Texture debugTexture, playTexture, leaderboardTexture, pauseTexture;
-    if (!debugTexture.loadFromFile("photos/files/images/debug.png") ||
-        !playTexture.loadFromFile("photos/files/images/play.png") ||
-        !leaderboardTexture.loadFromFile("photos/files/images/leaderboard.png") ||
-        !pauseTexture.loadFromFile("photos/files/images/pause.png")) {
-        std::cerr << "Failed to load texture file!" << std::endl;
-        return EXIT_FAILURE;
-    }
-
-    TileTextures textures;
-
-    HappyFaceButton happyface;
-    happyface.setPosition((columns / 2.0f * 32.0f) - 32.0f, 32.0f * (rows + 0.5));
-
-    Board board(rows, columns, numMines, textures, happyface);
-    board.draw(window, windowWidth / columns);
+    const sf::Texture& debugTexture = assets.texture("photos/files/images/debug.png");
+    const sf::Texture& playTexture = assets.texture("photos/files/images/play.png");
+    const sf::Texture& leaderboardTexture = assets.texture("photos/files/images/leaderboard.png");
+    const sf::Texture& pauseTexture = assets.texture("photos/files/images/pause.png");
+
+    TileAtlas atlas(assets);
+    if (endless) return playEndless(window, atlas, rows, columns, numMines, hasSeed ? seed : randomSeed());
+
+    HappyFaceButton happyface(assets);
+    happyface.setPosition(fieldWidth / 2.0f - 32.0f, fieldHeight + 16.0f);
+
+    // Boards are generated off the UI thread; a restart just takes the next one.
+    // In no-guess mode each board arrives with its start cell already opened.
+    // A configured seed is used for the first board and the rest follow from
+    // it, so a whole session can be replayed.
+    int startCell = (rows / 2) * columns + columns / 2;
+    uint64_t seedState = hasSeed ? seed : randomSeed();
+    bool firstBoard = true;
+    BoardPool boardPool(rows, columns, [&pool, rows, columns, numMines, noGuess, startCell, seedState, firstBoard,
+                                        mineCells = std::vector<int>()](Board& board, const std::atomic<bool>& stop) mutable {
+        uint64_t boardSeed = firstBoard ? seedState : splitmix64(seedState);
+        firstBoard = false;
+        if (not noGuess) {
+            board.reset(numMines, boardSeed);
+        } else if (not generateNoGuessLayout(rows, columns, numMines, startCell, boardSeed, pool, mineCells, 10000, &stop)) {
+            // Shutting down: the board is never handed out.
+            if (stop) return;
+            std::cerr << "No no-guess layout found, falling back to a random board" << std::endl;
+            board.reset(numMines, boardSeed);
+        } else {
+            board.reset(mineCells, boardSeed);
+            board.leftClick(startCell % columns, startCell / columns);
+        }
+    });
+    Board board = boardPool.take();
+    window.setTitle(windowTitle(board));
+
+    // Every game is recorded move by move and appended to the replay log
+    // when it ends; R plays the last one back in the window.
+    ReplayRecorder recorder;
+    recorder.start(board, gameClock, playername, not noGuess);
+    // Later appends would be unreadable behind a torn record.
+    if (!repairReplayLog(REPLAY_LOG)) std::cerr << "Could not repair " << REPLAY_LOG << std::endl;
+    Replay lastReplay;
+    std::unique_ptr<ReplayPlayer> viewer;
+    int viewerSpeed = 0;
+    sf::Clock viewerClock;
+    TileMap tilemap(atlas);
+    tilemap.resize(rows, columns, 32.0f);
+    Camera camera(sf::Vector2f(columns * 32.0f, rows * 32.0f), sf::Vector2f(fieldWidth, fieldHeight), window.getSize(), 32.0f);
+    // A left press on the board opens its cell on release, unless it became a drag.
+    bool leftArmed = false;
+    int pressedX = -1;
+    int pressedY = -1;
 
     sf::Vector2f buttonSize(debugTexture.getSize().x, debugTexture.getSize().y);
     sf::Vector2f buttonSize2(playTexture.getSize().x, playTexture.getSize().y);
     sf::Vector2f buttonSize3(leaderboardTexture.getSize().x, leaderboardTexture.getSize().y);
-    Button debugButton(debugTexture, sf::Vector2f((columns * 32) - 304, 32 * (rows + 0.5)), buttonSize);
-    Button playButton(pauseTexture, sf::Vector2f((columns * 32) - 240, 32 * (rows + 0.5)), buttonSize2);
-    Button leaderboardButton(leaderboardTexture, sf::Vector2f((columns * 32) - 176, 32 * (rows + 0.5)), buttonSize3);
-    Digit digit("photos/files/images/digits.png");
+    Button debugButton(debugTexture, sf::Vector2f(fieldWidth - 304, fieldHeight + 16), buttonSize);
+    Button playButton(pauseTexture, sf::Vector2f(fieldWidth - 240, fieldHeight + 16), buttonSize2);
+    Button leaderboardButton(leaderboardTexture, sf::Vector2f(fieldWidth - 176, fieldHeight + 16), buttonSize3);
+    Digit digit(assets.texture("photos/files/images/digits.png"));
+    if (assets.hasFailed()) {
+        std::cerr << "Failed to load texture file!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Pick up the game this player left unfinished on this board config.
+    AutoSaver autosaver(SAVE_FILE);
+    Board savedBoard(1, 1, std::vector<int>());
+    long long savedMs;
+    Replay savedReplay;
+    if (loadSavedGame(SAVE_FILE, savedBoard, savedMs, savedReplay) && savedReplay.player == playername &&
+        savedBoard.getRows() == rows && savedBoard.getColumns() == columns && savedBoard.getMineCount() == numMines &&
+        savedBoard.getGameState() == GameState::Playing) {
+        board = std::move(savedBoard);
+        recorder.resume(board, gameClock, savedReplay);
+        gameClock.restore(savedMs);
+        game_time = gameClock.elapsedSeconds();
+        if (board.isPaused()) playButton.setTexture(playTexture);
+        window.setTitle(windowTitle(board));
+        std::cout << "resumed saved game at " << game_time << " s" << std::endl;
+    }
+    auto autosave = [&] {
+        if (board.getGameState() == GameState::Playing && gameClock.elapsedMilliseconds() > 0) {
+            autosaver.save(board, gameClock.elapsedMilliseconds(), recorder.current());
+        }
+    };
 
+    // Every finished game goes to the log; the first run imports the old top five.
+    BoardConfig config{rows, columns, numMines};
+    GameStore store;
+    if (!store.open("photos/files/games.log")) {
+        std::cerr << "Could not open the game log, results will not be saved" << std::endl;
+    }
+    if (store.size() == 0) store.importLegacyLeaderboard("photos/files/leaderboard.txt", config);
     std::vector<int> times;
     std::vector<std::string> names;
     int changed_pos = -1;
-    readLeaderboardFile("photos/files/leaderboard.txt", times, names);
+    loadLeaderboard(store, config, times, names, changed_pos, -1);
+    LeaderboardOverlay leaderboard(font, fieldWidth, fieldHeight);
+    leaderboard.setEntries(times, names, changed_pos);
+    auto recordGame = [&](GameOutcome outcome) {
+        uint32_t id;
+        // A win counts at its winning move, the time its replay holds too.
+        const std::vector<ReplayMove>& moves = recorder.current().moves;
+        uint64_t timeMs = outcome == GameOutcome::Won && !moves.empty() ? moves.back().timeMs
+                                                                         : gameClock.elapsedMilliseconds();
+        GameRecord record{playername, config, board.getSeed(), timeMs, outcome, static_cast<int64_t>(std::time(nullptr))};
+        if (!store.append(record, id)) std::cerr << "Could not save the game result" << std::endl;
+        autosaver.discard();
+        lastReplay = recorder.current();
+        if (!appendReplay(REPLAY_LOG, lastReplay)) std::cerr << "Could not save the replay" << std::endl;
+        return id;
+    };
+
+    // Set whenever the HUD changes; the board tracks its own dirty cells.
+    bool redraw = true;
+
+    // P toggles shading hidden cells by their exact mine probability.
+    std::vector<double> probabilities;
+    bool showProbabilities = false;
+    bool probabilitiesStale = true;
+
+    // Every phase of the loop is timed. F3 shows recent frame times; F4
+    // writes the recent phases as a Chrome trace, for tracking down a stutter.
+    Profiler profiler;
+    ProfilerOverlay profilerOverlay(font);
+    bool showProfiler = false;
+
+    // Follows every reveal or chord on the board. Only the move that ends
+    // the game records it; clicks on a lost board change nothing.
+    auto finishMove = [&](GameState before, bool won) {
+        if (not board.getLastRevealed().empty()) probabilitiesStale = true;
+        if (before == GameState::Playing && board.getGameState() == GameState::Lost){
+            happyface.setLoseFace();
+            happyface.debug = false;
+            gameClock.pause();
+            recordGame(GameOutcome::Lost);
+        }
+        if(won){
+            happyface.setWinFace();
+            happyface.debug = false;
+            happyface.leaderboard_isopen = true;
+            gameClock.pause();
+            game_time = gameClock.elapsedSeconds();
+            loadLeaderboard(store, config, times, names, changed_pos, recordGame(GameOutcome::Won));
+            leaderboard.setEntries(times, names, changed_pos);
+            board.markAllDirty();
+        }
+    };
 
+    profiler.beginFrame();
     while (window.isOpen()) {
-        if (happyface.leaderboard_isopen){
-            showLeaderboardWindow(rows, columns, times, names, happyface.leaderboard_isopen, changed_pos);
+        //clock
+        bool playing;
+        {
+            ProfileScope scope(profiler, ProfilePhase::Clock);
+            playing = board.getGameState() == GameState::Playing && not happyface.debug;
+            if (not board.isPaused() && not happyface.leaderboard_isopen && not viewer && playing) gameClock.start();
+            else gameClock.pause();
+            if (not viewer && gameClock.elapsedSeconds() != game_time) {
+                game_time = gameClock.elapsedSeconds();
+                redraw = true;
+                std::cout << game_time << std::endl;
+                if (gameClock.isRunning() && game_time % AUTOSAVE_SECONDS == 0) autosave();
+            }
+        }
+
+        if (showProbabilities && probabilitiesStale) {
+            ProfileScope scope(profiler, ProfilePhase::Probabilities);
+            probabilities = computeMineProbabilities(board, pool);
+            probabilitiesStale = false;
+            board.markAllDirty();
         }
 
+        if (viewer) {
+            viewer->advance(viewerClock.restart().asMicroseconds() / 1000.0);
+            if (static_cast<int>(viewer->getTimeMs() / 1000) != game_time) redraw = true;
+        }
 
+        // While a replay plays, its board and time take the place of the game's.
+        Board& shown = viewer ? viewer->getBoard() : board;
+        // The overlay's numbers change every frame.
+        if (showProfiler) redraw = true;
+        if (redraw || shown.needsRedraw()) {
+            redraw = false;
+            uint64_t hudStart = profiler.now();
+            window.clear(sf::Color::White);
+            happyface.draw(window);
+            debugButton.draw(window);
+            playButton.draw(window);
+            leaderboardButton.draw(window);
+
+            //clock display
+            if (viewer) game_time = viewer->getTimeMs() / 1000;
+            digit.setPosition(sf::Vector2f(fieldWidth - 97, fieldHeight + 32));
+            digit.setDigit((game_time/60)/10);
+            digit.draw(window);
+            digit.setPosition(sf::Vector2f(fieldWidth - 97 + 21, fieldHeight + 32));
+            digit.setDigit((game_time/60)%10);
+            digit.draw(window);
+            digit.setPosition(sf::Vector2f(fieldWidth - 54, fieldHeight + 32));
+            digit.setDigit((game_time%60)/10);
+            digit.draw(window);
+            digit.setPosition(sf::Vector2f(fieldWidth - 54+21, fieldHeight + 32));
+            digit.setDigit((game_time%60)%10);
+            digit.draw(window);
+            int flag_count = numMines - shown.getFlagCount();
+            if (flag_count < 0){
+                digit.setPosition(sf::Vector2f(12, fieldHeight + 32));
+                digit.setDigit(10);
+                digit.draw(window);
+            }
+            flag_count = abs(flag_count);
+            digit.setPosition(sf::Vector2f(33, fieldHeight + 32));
+            digit.setDigit((flag_count/100));
+            digit.draw(window);
+            digit.setPosition(sf::Vector2f(33 + 21, fieldHeight + 32));
+            digit.setDigit((flag_count%100)/10);
+            digit.draw(window);
+            digit.setPosition(sf::Vector2f(33 + 42, fieldHeight + 32));
+            digit.setDigit((flag_count%100)%10);
+            digit.draw(window);
+            profiler.record(ProfilePhase::Hud, hudStart, profiler.now());
+            {
+                ProfileScope scope(profiler, ProfilePhase::Tiles);
+                if (viewer) {
+                    tilemap.update(shown, false, false, nullptr);
+                } else {
+                    bool covered = board.isPaused() || (happyface.leaderboard_isopen && playing);
+                    tilemap.update(board, covered, happyface.debug, showProbabilities ? &probabilities : nullptr);
+                }
+                tilemap.cull(camera.visibleArea(), camera.pixelsPerCell(32.0f));
+            }
+            {
+                ProfileScope scope(profiler, ProfilePhase::BoardDraw);
+                window.setView(camera.getView());
+                window.draw(tilemap);
+                window.setView(window.getDefaultView());
+            }
+            if (happyface.leaderboard_isopen && not viewer) window.draw(leaderboard);
+            if (showProfiler) {
+                profilerOverlay.setStats(profiler.frameStats());
+                window.draw(profilerOverlay);
+            }
+            ProfileScope scope(profiler, ProfilePhase::Display);
+            window.display();
+        }
+        profiler.endFrame();
+
+        // Block until input arrives; while the timer runs, wake for its next
+        // tick, and while a replay plays, for its next move.
         sf::Event event;
-        while (window.pollEvent(event)) {
+        bool hasEvent;
+        {
+            ProfileScope scope(profiler, ProfilePhase::Wait);
+            if (viewer && not viewer->finished()) {
+                double wait = std::min(viewer->msUntilNextMove(), 100.0);
+                hasEvent = waitEventFor(window, event, sf::microseconds(static_cast<sf::Int64>(wait * 1000)));
+            } else if (gameClock.isRunning()) {
+                hasEvent = waitEventFor(window, event, sf::milliseconds(gameClock.millisecondsToNextSecond()));
+            } else {
+                hasEvent = window.waitEvent(event);
+            }
+        }
+        profiler.beginFrame();
+        uint64_t eventsStart = profiler.now();
+        for (; hasEvent; hasEvent = window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
+                // The saver finishes writing before main returns.
+                autosave();
                 window.close();
+            } else if (event.type == sf::Event::GainedFocus || event.type == sf::Event::Resized) {
+                redraw = true;
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R && not lastReplay.moves.empty()) {
+                viewer.reset(new ReplayPlayer(lastReplay));
+                viewer->setSpeed(REPLAY_SPEEDS[viewerSpeed]);
+                viewerClock.restart();
+                redraw = true;
+            } else if (event.type == sf::Event::KeyPressed && viewer
+                       && (event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Subtract)) {
+                int last = sizeof(REPLAY_SPEEDS) / sizeof(REPLAY_SPEEDS[0]) - 1;
+                viewerSpeed += event.key.code == sf::Keyboard::Add ? 1 : -1;
+                viewerSpeed = std::max(0, std::min(viewerSpeed, last));
+                viewer->setSpeed(REPLAY_SPEEDS[viewerSpeed]);
+                std::cout << "replay speed " << viewer->getSpeed() << "x" << std::endl;
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape && viewer) {
+                viewer.reset();
+                game_time = gameClock.elapsedSeconds();
+                board.markAllDirty();
+                redraw = true;
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                showProfiler = not showProfiler;
+                board.markAllDirty();
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F4) {
+                if (profiler.writeChromeTrace(TRACE_FILE)) std::cout << "trace written to " << TRACE_FILE << std::endl;
+                else std::cerr << "Could not write " << TRACE_FILE << std::endl;
+            } else if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+                sf::Vector2i pixel(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                if (camera.containsPixel(pixel) && camera.zoomAt(window, pixel, event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f)) {
+                    redraw = true;
+                }
+            } else if (event.type == sf::Event::MouseMoved) {
+                if (camera.dragTo(sf::Vector2i(event.mouseMove.x, event.mouseMove.y))) redraw = true;
+            } else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
+                bool panned = camera.endDrag();
+                if (leftArmed && not panned && not viewer) {
+                    ProfileScope scope(profiler, ProfilePhase::BoardMove);
+                    GameState before = board.getGameState();
+                    bool won = board.leftClick(pressedX, pressedY);
+                    finishMove(before, won);
+                    redraw = true;
+                }
+                leftArmed = false;
+            } else if (viewer) {
+                // Watching a replay: the game takes no input until Escape,
+                // but the view can still be dragged.
+                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                    sf::Vector2i pixel(event.mouseButton.x, event.mouseButton.y);
+                    if (camera.containsPixel(pixel)) camera.beginDrag(pixel);
+                }
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape && happyface.leaderboard_isopen) {
+                happyface.leaderboard_isopen = false;
+                board.markAllDirty();
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P) {
+                showProbabilities = not showProbabilities;
+                board.markAllDirty();
             } else if (event.type == sf::Event::MouseButtonPressed) {
+                redraw = true;
                 float mouseX = sf::Mouse::getPosition(window).x;
                 float mouseY = sf::Mouse::getPosition(window).y;
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    if (happyface.handleClick(mouseX, mouseY)) {
-                        Board new_board(rows, columns, numMines, textures, happyface);
-                        board = new_board;
+                sf::Mouse::Button button = event.mouseButton.button;
+                // The control or cell under the cursor; cells are -1 off the board area.
+                sf::Vector2i pixel(event.mouseButton.x, event.mouseButton.y);
+                bool onFace, onDebug, onPlay, onLeaderboard, onField;
+                int cellX, cellY;
+                {
+                    ProfileScope scope(profiler, ProfilePhase::HitTest);
+                    onFace = happyface.handleClick(mouseX, mouseY);
+                    onDebug = debugButton.handleClick(mouseX, mouseY);
+                    onPlay = playButton.handleClick(mouseX, mouseY);
+                    onLeaderboard = leaderboardButton.handleClick(mouseX, mouseY);
+                    onField = camera.containsPixel(pixel);
+                    sf::Vector2f point = camera.mapPixel(window, pixel);
+                    cellX = onField ? static_cast<int>(std::floor(point.x / 32)) : -1;
+                    cellY = onField ? static_cast<int>(std::floor(point.y / 32)) : -1;
+                }
+                // Middle click, or pressing one button while the other is held, chords.
+                bool chording = button == sf::Mouse::Middle
+                        || (button == sf::Mouse::Left && sf::Mouse::isButtonPressed(sf::Mouse::Right))
+                        || (button == sf::Mouse::Right && sf::Mouse::isButtonPressed(sf::Mouse::Left));
+                if (happyface.leaderboard_isopen && (chording || button != sf::Mouse::Left)) {
+                    // While the leaderboard is up only plain left clicks count.
+                } else if (chording) {
+                    // One slice per move, the bookkeeping after it included.
+                    ProfileScope scope(profiler, ProfilePhase::BoardMove);
+                    leftArmed = false;
+                    camera.endDrag();
+                    GameState before = board.getGameState();
+                    bool won = board.chord(cellX, cellY);
+                    finishMove(before, won);
+                } else if (button == sf::Mouse::Left) {
+                    if (onFace) {
+                        if (board.getGameState() == GameState::Playing && gameClock.elapsedMilliseconds() > 0) {
+                            recordGame(GameOutcome::Abandoned);
+                        }
+                        boardPool.exchange(board);
+                        recorder.start(board, gameClock, playername, not noGuess);
+                        window.setTitle(windowTitle(board));
                         happyface.setDefaultFace();
-                        game_time = 0;
-                        happyface.paused = false;
+                        gameClock.reset();
                         playButton.setTexture(pauseTexture);
-                        happyface.game_state = 0;
+                        happyface.debug = false;
+                        probabilitiesStale = true;
                     }
-                    else if (debugButton.handleClick(mouseX, mouseY)){
-                        if (happyface.game_state == 0) happyface.game_state = 2;
-                        else if (happyface.game_state == 2) happyface.game_state = 0;
+                    else if (onDebug){
+                        if (board.getGameState() == GameState::Playing) happyface.debug = not happyface.debug;
+                        board.markAllDirty();
                     }
-                    else if (playButton.handleClick(mouseX, mouseY)){
-                        if (happyface.paused) {
+                    else if (onPlay){
+                        if (board.isPaused()) {
                             playButton.setTexture(pauseTexture);
-                            happyface.paused = false;
+                            board.setPaused(false);
                         }
                         else {
-                            auto time2 = std::chrono::high_resolution_clock::now();
-                            std::chrono::duration<double, std::milli> duration = time2 - time1;
-                            time_duration += duration.count();
-
                             playButton.setTexture(playTexture);
 
-                            happyface.paused = true;
+                            board.setPaused(true);
+                            autosave();
                         }
+                        board.markAllDirty();
                     }
-                    else if (leaderboardButton.handleClick(mouseX, mouseY)){
+                    else if (onLeaderboard){
                         happyface.leaderboard_isopen = not happyface.leaderboard_isopen;
+                        board.markAllDirty();
                     }
-                    else {
-
-                        if(board.leftClick(mouseX/32, mouseY/32)){
-                            happyface.leaderboard_isopen = true;
-                            for (int i = 0; i < 5; ++i){
-                                if (game_time < times[i]){
-                                    times.insert(times.begin()+i, game_time);
-                                    times.erase(times.end()-1);
-                                    names.insert(names.begin()+i, playername);
-                                    names.erase(names.end()-1);
-                                    changed_pos = i;
-                                    break;
-                                }
-                            }
-                            writeLeaderboardFile("photos/files/leaderboard.txt", times, names);
-                        }
+                    else if (happyface.leaderboard_isopen) {
+                        // A click on the board while the leaderboard is up only closes it.
+                        happyface.leaderboard_isopen = false;
+                        board.markAllDirty();
                     }
-                } else if (event.mouseButton.button == sf::Mouse::Right) {
-                    board.rightClick(mouseX/32, mouseY/32);
+                    else if (onField) {
+                        leftArmed = true;
+                        pressedX = cellX;
+                        pressedY = cellY;
+                        camera.beginDrag(pixel);
+                    }
+                } else if (button == sf::Mouse::Right) {
+                    ProfileScope scope(profiler, ProfilePhase::BoardMove);
+                    board.rightClick(cellX, cellY);
                 }
             }
         }
-
-        //clock
-        if (not happyface.paused && happyface.game_state == 0) {
-            auto time2 = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double, std::milli> duration = time2 - time1;
-            time_duration += duration.count();
-            time1 = time2;
-            if (time_duration > 1000) {
-                game_time += 1;
-                time_duration = 0;
-                std::cout << game_time << std::endl;
-            }
-        }
-
-
-
-        window.clear(sf::Color::White);
-        happyface.draw(window);
-        debugButton.draw(window);
-        playButton.draw(window);
-        leaderboardButton.draw(window);
-
-        //clock display
-        digit.setPosition(sf::Vector2f(columns * 32 - 97, 32 * (rows + 0.5) + 16));
-        digit.setDigit((game_time/60)/10);
-        digit.draw(window);
-        digit.setPosition(sf::Vector2f(columns * 32 - 97 + 21, 32 * (rows + 0.5) + 16));
-        digit.setDigit((game_time/60)%10);
-        digit.draw(window);
-        digit.setPosition(sf::Vector2f(columns * 32 - 54, 32 * (rows + 0.5) + 16));
-        digit.setDigit((game_time%60)/10);
-        digit.draw(window);
-        digit.setPosition(sf::Vector2f(columns * 32 - 54+21, 32 * (rows + 0.5) + 16));
-        digit.setDigit((game_time%60)%10);
-        digit.draw(window);
-        int flag_count = numMines - board.getFlagCount();
-        if (flag_count < 0){
-            digit.setPosition(sf::Vector2f(12, 32 * (rows + 0.5) + 16));
-            digit.setDigit(10);
-            digit.draw(window);
-        }
-        flag_count = abs(flag_count);
-        digit.setPosition(sf::Vector2f(33, 32 * (rows + 0.5) + 16));
-        digit.setDigit((flag_count/100));
-        digit.draw(window);
-        digit.setPosition(sf::Vector2f(33 + 21, 32 * (rows + 0.5) + 16));
-        digit.setDigit((flag_count%100)/10);
-        digit.draw(window);
-        digit.setPosition(sf::Vector2f(33 + 42, 32 * (rows + 0.5) + 16));
-        digit.setDigit((flag_count%100)%10);
-        digit.draw(window);
-        board.draw(window, windowWidth / columns);
+        profiler.record(ProfilePhase::Events, eventsStart, profiler.now());
     }
     return 0;
 }
@@ -0,0 +1,101 @@
+#include "noguess.h"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <utility>
+#include "board.h"
+#include "rng.h"
+#include "solver.h"
+
+bool generateNoGuessLayout(int rows, int columns, int numMines, int startCell, uint64_t seed, ThreadPool& pool,
+                           std::vector<int>& mineCells, int maxAttempts, const std::atomic<bool>* stop) {
+    int startRow = startCell / columns;
+    int startCol = startCell % columns;
+    std::vector<int> candidates;
+    for (int i = 0; i < rows * columns; ++i) {
+        if (std::abs(i / columns - startRow) > 1 || std::abs(i % columns - startCol) > 1) candidates.push_back(i);
+    }
+    if (numMines > static_cast<int>(candidates.size())) return false;
+
+    // Lowest candidate found so far; maxAttempts while there is none.
+    std::atomic<int> best(maxAttempts);
+    std::atomic<int> nextAttempt(0);
+    std::mutex resultMutex;
+
+    pool.parallelFor(static_cast<int>(pool.size()), [&](int) {
+        std::vector<int> pickable;
+        std::vector<int> mines;
+        std::vector<int> frontierMines;
+        std::vector<int> interior;
+        Board board(rows, columns, mines);
+        Solver solver(board);
+
+        while (true) {
+            int attempt = nextAttempt.fetch_add(1);
+            if (attempt >= best.load() || (stop && stop->load())) return;
+            uint64_t attemptState = seed + static_cast<uint64_t>(attempt);
+            Rng rng(splitmix64(attemptState));
+
+            // Partial Fisher-Yates: the first numMines entries become the mines.
+            pickable = candidates;
+            for (int i = 0; i < numMines; ++i) {
+                int pick = i + static_cast<int>(rng.below(pickable.size() - i));
+                std::swap(pickable[i], pickable[pick]);
+            }
+            mines.assign(pickable.begin(), pickable.begin() + numMines);
+
+            for (int repair = 0; repair <= numMines; ++repair) {
+                if (attempt > best.load() || (stop && stop->load())) break;
+                board.reset(mines, seed);
+                board.leftClick(startCol, startRow);
+                solver.reset();
+                if (autoPlay(board, solver)) {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (attempt < best.load()) {
+                        best.store(attempt);
+                        mineCells = mines;
+                    }
+                    break;
+                }
+
+                // Stuck: split the hidden cells into undecided mines next to
+                // a number and cells with no revealed neighbour.
+                frontierMines.clear();
+                interior.clear();
+                for (int m = 0; m < numMines; ++m) {
+                    int row = mines[m] / columns;
+                    int col = mines[m] % columns;
+                    if (solver.isMine(row, col)) continue;
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            int ny = row + dy;
+                            int nx = col + dx;
+                            if (ny < 0 || ny >= rows || nx < 0 || nx >= columns || not board.isRevealed(ny, nx)) continue;
+                            if (frontierMines.empty() || frontierMines.back() != m) frontierMines.push_back(m);
+                        }
+                    }
+                }
+                for (int row = 0; row < rows; ++row) {
+                    for (int col = 0; col < columns; ++col) {
+                        if (board.hasMine(row, col) || board.isRevealed(row, col)) continue;
+                        bool seen = false;
+                        for (int dy = -1; dy <= 1 && not seen; ++dy) {
+                            for (int dx = -1; dx <= 1 && not seen; ++dx) {
+                                int ny = row + dy;
+                                int nx = col + dx;
+                                seen = ny >= 0 && ny < rows && nx >= 0 && nx < columns && board.isRevealed(ny, nx);
+                            }
+                        }
+                        if (not seen) interior.push_back(row * columns + col);
+                    }
+                }
+                if (frontierMines.empty() || interior.empty()) break;
+
+                int moved = frontierMines[rng.below(frontierMines.size())];
+                mines[moved] = interior[rng.below(interior.size())];
+            }
+        }
+    });
+
+    return best.load() < maxAttempts && not (stop && stop->load());
+}
@@ -0,0 +1,25 @@
+#ifndef MINESWEEPER_NOGUESS_H
+#define MINESWEEPER_NOGUESS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "threadpool.h"
+
+// Searches for a mine layout that the solver can clear from the start cell
+// without ever guessing. The start cell and its neighbours are kept free of
+// mines so the first reveal opens an area. Every pool thread generates
+// random candidates, replays each with the solver, and when it gets stuck
+// moves one undecided frontier mine to a cell the player has no information
+// about yet. A candidate still stuck after numMines repairs is rejected.
+// Candidate k draws only from a generator derived from seed and k, and the
+// lowest-numbered success wins: once one is found, higher candidates are
+// cancelled, so a seed gives the same layout on any number of threads.
+// Returns false, leaving mineCells untouched, if maxAttempts candidates
+// all fail, or as soon as stop is set, checked before every candidate and
+// repair.
+bool generateNoGuessLayout(int rows, int columns, int numMines, int startCell, uint64_t seed, ThreadPool& pool,
+                           std::vector<int>& mineCells, int maxAttempts = 10000,
+                           const std::atomic<bool>* stop = nullptr);
+
+#endif
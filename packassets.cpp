@@ -0,0 +1,30 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assetcache.h"
+#include "threadpool.h"
+#include "tilemap.h"
+
+// Build step: packs every image the game uses, its font and the composited
+// tile atlas into one bundle the game loads with a single read. Run it from
+// the directory holding photos/.
+int main(int argc, char* argv[]) {
+    std::string output = argc > 1 ? argv[1] : "assets.bundle";
+
+    ThreadPool pool;
+    AssetCache assets;
+    std::vector<std::string> images = gameImagePaths();
+    if (!assets.preload(images, {}, pool)) {
+        std::cerr << "Failed to load the game images" << std::endl;
+        return 1;
+    }
+    TileAtlas::atlasImage(assets);
+    images.push_back(TileAtlas::ATLAS_NAME);
+
+    if (!assets.writeBundle(output, images, {GAME_FONT_PATH})) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << output << std::endl;
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include "probability.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+
+namespace {
+
+// Ways[k] counts the layouts with exactly k mines.
+typedef std::vector<double> Ways;
+
+struct Constraint {
+    int remaining;
+    std::vector<int> variables;
+};
+
+struct Component {
+    std::vector<int> cells;
+    std::vector<Constraint> constraints;
+    Ways total;
+    std::vector<Ways> mineWays;
+};
+
+void addShifted(Ways& into, const Ways& from, int shift, double scale) {
+    if (into.size() < from.size() + shift) into.resize(from.size() + shift, 0.0);
+    for (std::size_t k = 0; k < from.size(); ++k) into[k + shift] += from[k] * scale;
+}
+
+Ways convolve(const Ways& a, const Ways& b) {
+    if (a.empty() || b.empty()) return Ways();
+    Ways result(a.size() + b.size() - 1, 0.0);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == 0.0) continue;
+        for (std::size_t j = 0; j < b.size(); ++j) result[i + j] += a[i] * b[j];
+    }
+    return result;
+}
+
+double logChoose(int n, int k) {
+    return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+}
+
+// Counts the layouts of one component. Cells are assigned one at a time;
+// the state after each step is the remaining mine count of every
+// constraint that has some cells assigned and some not, so layouts that
+// agree on those counts are merged. A forward pass counts the ways to
+// reach each state and a backward pass the ways to finish from it, which
+// together give the mine count of every cell.
+void countComponent(Component& component) {
+    int n = static_cast<int>(component.cells.size());
+    int m = static_cast<int>(component.constraints.size());
+
+    std::vector<std::vector<int>> constraintsOf(n);
+    std::vector<int> first(m, n), last(m, -1);
+    for (int c = 0; c < m; ++c) {
+        for (int v : component.constraints[c].variables) {
+            constraintsOf[v].push_back(c);
+            first[c] = std::min(first[c], v);
+            last[c] = std::max(last[c], v);
+        }
+    }
+    // Cells of constraint c at position i or later.
+    auto unassigned = [&](int c, int i) {
+        const std::vector<int>& cells = component.constraints[c].variables;
+        return static_cast<int>(cells.end() - std::lower_bound(cells.begin(), cells.end(), i));
+    };
+    // active[i]: constraints whose counts make up the state before cell i.
+    std::vector<std::vector<int>> active(n + 1);
+    for (int c = 0; c < m; ++c) {
+        for (int i = first[c]; i <= last[c]; ++i) active[i].push_back(c);
+    }
+
+    typedef std::string State;
+    auto transition = [&](int i, const State& state, int value, State& next) {
+        next.clear();
+        for (std::size_t slot = 0; slot < active[i + 1].size(); ++slot) {
+            int c = active[i + 1][slot];
+            int remaining;
+            std::vector<int>::const_iterator found = std::lower_bound(active[i].begin(), active[i].end(), c);
+            if (found != active[i].end() && *found == c) remaining = state[found - active[i].begin()];
+            else remaining = component.constraints[c].remaining;
+            for (int owner : constraintsOf[i]) {
+                if (owner == c) remaining -= value;
+            }
+            if (remaining < 0 || remaining > unassigned(c, i + 1)) return false;
+            next.push_back(static_cast<char>(remaining));
+        }
+        // Constraints closed by this cell must be exactly satisfied.
+        for (int c : constraintsOf[i]) {
+            if (last[c] != i) continue;
+            int remaining;
+            std::vector<int>::const_iterator found = std::lower_bound(active[i].begin(), active[i].end(), c);
+            if (found != active[i].end() && *found == c) remaining = state[found - active[i].begin()];
+            else remaining = component.constraints[c].remaining;
+            if (remaining != value) return false;
+        }
+        return true;
+    };
+
+    std::vector<std::unordered_map<State, Ways>> forward(n + 1);
+    State start;
+    for (int c : active[0]) start.push_back(static_cast<char>(component.constraints[c].remaining));
+    forward[0][start] = Ways(1, 1.0);
+    State next;
+    for (int i = 0; i < n; ++i) {
+        for (const auto& entry : forward[i]) {
+            for (int value = 0; value <= 1; ++value) {
+                if (transition(i, entry.first, value, next)) addShifted(forward[i + 1][next], entry.second, value, 1.0);
+            }
+        }
+    }
+
+    std::vector<std::unordered_map<State, Ways>> backward(n + 1);
+    for (const auto& entry : forward[n]) backward[n][entry.first] = Ways(1, 1.0);
+    component.mineWays.assign(n, Ways());
+    for (int i = n - 1; i >= 0; --i) {
+        for (const auto& entry : forward[i]) {
+            Ways& ways = backward[i][entry.first];
+            for (int value = 0; value <= 1; ++value) {
+                if (not transition(i, entry.first, value, next)) continue;
+                std::unordered_map<State, Ways>::const_iterator after = backward[i + 1].find(next);
+                if (after == backward[i + 1].end()) continue;
+                addShifted(ways, after->second, value, 1.0);
+                if (value == 1) {
+                    Ways through = convolve(entry.second, after->second);
+                    addShifted(component.mineWays[i], through, 1, 1.0);
+                }
+            }
+        }
+        backward[i + 1].clear();
+    }
+
+    component.total.clear();
+    for (const auto& entry : forward[0]) {
+        std::unordered_map<State, Ways>::const_iterator from = backward[0].find(entry.first);
+        if (from != backward[0].end()) component.total = convolve(entry.second, from->second);
+    }
+
+    // Only ratios matter; keep the numbers near 1 so products of many
+    // components stay in range.
+    double scale = 0.0;
+    for (double w : component.total) scale = std::max(scale, w);
+    if (scale > 0.0) {
+        for (double& w : component.total) w /= scale;
+        for (Ways& ways : component.mineWays) {
+            for (double& w : ways) w /= scale;
+        }
+    }
+}
+
+}
+
+std::vector<double> computeMineProbabilities(const Board& board, ThreadPool& pool) {
+    int rows = board.getRows();
+    int columns = board.getColumns();
+    int cellCount = rows * columns;
+    std::vector<double> probability(cellCount, 0.0);
+
+    // Hidden cells touching a revealed number become variables, joined
+    // into components through the numbers they share.
+    std::vector<int> variableOf(cellCount, -1);
+    std::vector<int> variables;
+    std::vector<int> parent;
+    auto findRoot = [&](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    std::vector<Constraint> constraints;
+    int hiddenCount = 0;
+    int mines = board.getMineCount();
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            if (not board.isRevealed(row, col)) {
+                ++hiddenCount;
+                continue;
+            }
+            if (board.hasMine(row, col)) {
+                --mines;
+                continue;
+            }
+            Constraint constraint;
+            constraint.remaining = board.getAdjacentMines(row, col);
+            for (int ny = row - 1; ny <= row + 1; ++ny) {
+                for (int nx = col - 1; nx <= col + 1; ++nx) {
+                    if (ny < 0 || ny >= rows || nx < 0 || nx >= columns || board.isRevealed(ny, nx)) continue;
+                    int cell = ny * columns + nx;
+                    if (variableOf[cell] < 0) {
+                        variableOf[cell] = static_cast<int>(variables.size());
+                        variables.push_back(cell);
+                        parent.push_back(variableOf[cell]);
+                    }
+                    constraint.variables.push_back(variableOf[cell]);
+                }
+            }
+            if (constraint.variables.empty()) continue;
+            for (std::size_t i = 1; i < constraint.variables.size(); ++i) {
+                parent[findRoot(constraint.variables[i])] = findRoot(constraint.variables[0]);
+            }
+            constraints.push_back(constraint);
+        }
+    }
+
+    std::map<int, int> componentOfRoot;
+    std::vector<Component> components;
+    std::vector<int> componentOfVariable(variables.size());
+    for (std::size_t v = 0; v < variables.size(); ++v) {
+        int root = findRoot(static_cast<int>(v));
+        std::map<int, int>::iterator found = componentOfRoot.find(root);
+        if (found == componentOfRoot.end()) {
+            found = componentOfRoot.insert(std::make_pair(root, static_cast<int>(components.size()))).first;
+            components.push_back(Component());
+        }
+        componentOfVariable[v] = found->second;
+    }
+
+    // Order each component's cells breadth first along shared numbers, so
+    // few constraints are open at once and the DP state stays small.
+    std::vector<std::vector<int>> constraintsOfVariable(variables.size());
+    for (std::size_t c = 0; c < constraints.size(); ++c) {
+        for (int v : constraints[c].variables) constraintsOfVariable[v].push_back(static_cast<int>(c));
+    }
+    std::vector<int> position(variables.size(), -1);
+    for (std::size_t v = 0; v < variables.size(); ++v) {
+        if (position[v] >= 0) continue;
+        Component& component = components[componentOfVariable[v]];
+        if (not component.cells.empty()) continue;
+        std::vector<int> queue(1, static_cast<int>(v));
+        position[v] = 0;
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            int current = queue[head];
+            component.cells.push_back(variables[current]);
+            for (int c : constraintsOfVariable[current]) {
+                for (int other : constraints[c].variables) {
+                    if (position[other] >= 0) continue;
+                    position[other] = static_cast<int>(queue.size());
+                    queue.push_back(other);
+                }
+            }
+        }
+    }
+    for (const Constraint& constraint : constraints) {
+        Component& component = components[componentOfVariable[constraint.variables[0]]];
+        Constraint local;
+        local.remaining = constraint.remaining;
+        for (int v : constraint.variables) local.variables.push_back(position[v]);
+        std::sort(local.variables.begin(), local.variables.end());
+        component.constraints.push_back(local);
+    }
+
+    pool.parallelFor(static_cast<int>(components.size()), [&](int c) {
+        countComponent(components[c]);
+    });
+
+    // Mine-count distribution of all components together, and of all but
+    // one, from prefix and suffix products.
+    int count = static_cast<int>(components.size());
+    std::vector<Ways> prefix(count + 1), suffix(count + 1);
+    prefix[0] = Ways(1, 1.0);
+    suffix[count] = Ways(1, 1.0);
+    for (int c = 0; c < count; ++c) prefix[c + 1] = convolve(prefix[c], components[c].total);
+    for (int c = count - 1; c >= 0; --c) suffix[c] = convolve(suffix[c + 1], components[c].total);
+    const Ways& all = prefix[count];
+    if (all.empty()) return probability;
+
+    // weight[k]: layouts of the untouched cells when the frontier holds k mines.
+    int untouched = hiddenCount - static_cast<int>(variables.size());
+    std::vector<double> logWeight(all.size() + 1, -INFINITY);
+    double maxLog = -INFINITY;
+    for (std::size_t k = 0; k < logWeight.size(); ++k) {
+        int left = mines - static_cast<int>(k);
+        if (left < 0 || left > untouched) continue;
+        logWeight[k] = logChoose(untouched, left);
+        if (all.size() > k && all[k] > 0.0) maxLog = std::max(maxLog, logWeight[k]);
+    }
+    if (maxLog == -INFINITY) return probability;
+    std::vector<double> weight(logWeight.size(), 0.0);
+    for (std::size_t k = 0; k < weight.size(); ++k) {
+        if (logWeight[k] != -INFINITY) weight[k] = std::exp(logWeight[k] - maxLog);
+    }
+
+    double totalWeight = 0.0;
+    double untouchedMines = 0.0;
+    for (std::size_t k = 0; k < all.size(); ++k) {
+        totalWeight += all[k] * weight[k];
+        if (untouched > 0) untouchedMines += all[k] * weight[k] * (mines - static_cast<double>(k)) / untouched;
+    }
+    if (totalWeight <= 0.0) return probability;
+
+    for (int c = 0; c < count; ++c) {
+        Ways others = convolve(prefix[c], suffix[c + 1]);
+        const Component& component = components[c];
+        for (std::size_t v = 0; v < component.cells.size(); ++v) {
+            double sum = 0.0;
+            const Ways& mineWays = component.mineWays[v];
+            for (std::size_t k = 0; k < mineWays.size(); ++k) {
+                if (mineWays[k] == 0.0) continue;
+                for (std::size_t j = 0; j < others.size() && k + j < weight.size(); ++j) {
+                    sum += mineWays[k] * others[j] * weight[k + j];
+                }
+            }
+            probability[component.cells[v]] = sum / totalWeight;
+        }
+    }
+
+    double untouchedProbability = untouchedMines / totalWeight;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            int cell = row * columns + col;
+            if (not board.isRevealed(row, col) && variableOf[cell] < 0) probability[cell] = untouchedProbability;
+        }
+    }
+    return probability;
+}
@@ -0,0 +1,20 @@
+#ifndef MINESWEEPER_PROBABILITY_H
+#define MINESWEEPER_PROBABILITY_H
+
+#include <vector>
+#include "board.h"
+#include "threadpool.h"
+
+// Exact chance that each hidden cell holds a mine, given every revealed
+// number and the board's total mine count, with all consistent layouts
+// equally likely. Hidden cells next to a revealed number are split into
+// independent components; each component is counted by dynamic
+// programming over its cells, memoising on the remaining counts of the
+// constraints that are still open, and the components run in parallel on
+// the pool. The per-component counts are then combined with the cells no
+// number touches using binomial weights for the mines left over.
+//
+// Returns one value per cell in row-major order; revealed cells are 0.
+std::vector<double> computeMineProbabilities(const Board& board, ThreadPool& pool);
+
+#endif
@@ -0,0 +1,170 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+const char* profilePhaseName(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::Frame: return "frame";
+        case ProfilePhase::Wait: return "wait";
+        case ProfilePhase::Events: return "events";
+        case ProfilePhase::HitTest: return "hit test";
+        case ProfilePhase::BoardMove: return "board move";
+        case ProfilePhase::Clock: return "clock";
+        case ProfilePhase::Probabilities: return "probabilities";
+        case ProfilePhase::Hud: return "hud";
+        case ProfilePhase::Tiles: return "tiles";
+        case ProfilePhase::BoardDraw: return "board draw";
+        case ProfilePhase::Display: return "display";
+        default: return "?";
+    }
+}
+
+// Numbers threads in the order they first record.
+static uint16_t currentThread() {
+    static std::atomic<uint16_t> nextThread(0);
+    thread_local uint16_t thread = nextThread.fetch_add(1);
+    return thread;
+}
+
+ProfileRing::ProfileRing(std::size_t capacity) : head(0), dropped(0) {
+    std::size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots.reset(new Slot[size]);
+    mask = size - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+// A slot at position pos is free for writing when its sequence is pos and
+// holds an event for reading when it is pos + 1.
+bool ProfileRing::push(const ProfileEvent& event) {
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots[pos & mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence - pos);
+        if (difference == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.event = event;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            // The reader has not yet freed this slot from the last lap.
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool ProfileRing::pop(ProfileEvent& event) {
+    Slot& slot = slots[tail & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+    event = slot.event;
+    // Free for the writer one lap later.
+    slot.sequence.store(tail + mask + 1, std::memory_order_release);
+    ++tail;
+    return true;
+}
+
+uint64_t ProfileRing::droppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+Profiler::Profiler(std::size_t ringCapacity)
+        : origin(clock::now()), ring(ringCapacity), history(HISTORY_EVENTS), frameMs(HISTORY_FRAMES) {}
+
+uint64_t Profiler::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin).count();
+}
+
+void Profiler::record(ProfilePhase phase, uint64_t startNs, uint64_t endNs) {
+    ring.push(ProfileEvent{startNs, endNs - startNs, phase, currentThread()});
+}
+
+void Profiler::beginFrame() {
+    frameStart = now();
+    frameThread = currentThread();
+    inFrame = true;
+}
+
+void Profiler::endFrame() {
+    if (not inFrame) return;
+    inFrame = false;
+    uint64_t end = now();
+    record(ProfilePhase::Frame, frameStart, end);
+    frameMs[frameNext] = static_cast<float>((end - frameStart) / 1e6);
+    frameNext = (frameNext + 1) % frameMs.size();
+    frameCount = std::min(frameCount + 1, static_cast<int>(HISTORY_FRAMES));
+    collect();
+}
+
+void Profiler::collect() {
+    ProfileEvent event;
+    while (ring.pop(event)) {
+        history[historyNext] = event;
+        historyNext = (historyNext + 1) % history.size();
+        if (historyNext == 0) historyFull = true;
+    }
+}
+
+Profiler::FrameStats Profiler::frameStats() const {
+    FrameStats stats;
+    stats.frames = frameCount;
+    stats.dropped = ring.droppedCount();
+    if (frameCount > 0) {
+        std::vector<float> sorted(frameMs.begin(), frameMs.begin() + frameCount);
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) { return sorted[static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5)]; };
+        stats.p50Ms = percentile(0.50);
+        stats.p90Ms = percentile(0.90);
+        stats.p99Ms = percentile(0.99);
+        stats.maxMs = sorted.back();
+        for (float ms : sorted) {
+            ++stats.histogram[std::min(static_cast<int>(ms), HISTOGRAM_BINS - 1)];
+        }
+    }
+
+    const int phases = static_cast<int>(ProfilePhase::Count);
+    long long counts[phases] = {};
+    std::size_t size = historyFull ? history.size() : historyNext;
+    for (std::size_t i = 0; i < size; ++i) {
+        int phase = static_cast<int>(history[i].phase);
+        double ms = history[i].durationNs / 1e6;
+        ++counts[phase];
+        stats.phaseMeanMs[phase] += ms;
+        stats.phaseMaxMs[phase] = std::max(stats.phaseMaxMs[phase], ms);
+    }
+    for (int phase = 0; phase < phases; ++phase) {
+        if (counts[phase] > 0) stats.phaseMeanMs[phase] /= counts[phase];
+    }
+    return stats;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    collect();
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"game\"}}",
+                  static_cast<unsigned>(frameThread));
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    json += line;
+    std::size_t size = historyFull ? history.size() : historyNext;
+    std::size_t first = historyFull ? historyNext : 0;
+    for (std::size_t n = 0; n < size; ++n) {
+        const ProfileEvent& event = history[(first + n) % history.size()];
+        // Trace times are microseconds.
+        std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      profilePhaseName(event.phase), static_cast<unsigned>(event.thread), event.startNs / 1e3,
+                      event.durationNs / 1e3);
+        json += line;
+    }
+    json += "\n]}\n";
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return static_cast<bool>(out.flush());
+}
@@ -0,0 +1,138 @@
+#ifndef MINESWEEPER_PROFILER_H
+#define MINESWEEPER_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class ProfilePhase : uint8_t {
+    Frame,
+    Wait,
+    Events,
+    HitTest,
+    BoardMove,
+    Clock,
+    Probabilities,
+    Hud,
+    Tiles,
+    BoardDraw,
+    Display,
+    Count,
+};
+
+const char* profilePhaseName(ProfilePhase phase);
+
+struct ProfileEvent {
+    // Nanoseconds since the profiler was created.
+    uint64_t startNs;
+    uint64_t durationNs;
+    ProfilePhase phase;
+    // Small per-thread number, in the order threads first record.
+    uint16_t thread;
+};
+
+// Bounded lock-free queue of timing events. Any thread may push, one thread
+// pops. Each slot carries a sequence number saying whether it is free for
+// the writer at a given position or filled for the reader, so neither side
+// ever waits on the other. A push into a full ring drops the event.
+class ProfileRing {
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        ProfileEvent event;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;
+    std::atomic<uint64_t> head;
+    // Only touched by the reader.
+    uint64_t tail = 0;
+    std::atomic<uint64_t> dropped;
+
+public:
+    // capacity is rounded up to a power of two.
+    explicit ProfileRing(std::size_t capacity);
+    ProfileRing(const ProfileRing&) = delete;
+    ProfileRing& operator=(const ProfileRing&) = delete;
+
+    bool push(const ProfileEvent& event);
+    bool pop(ProfileEvent& event);
+    uint64_t droppedCount() const;
+};
+
+// Frame profiler for the game loop. Timers push into a ProfileRing from any
+// thread; once a frame the game thread drains it into a fixed history of
+// recent events, which the stats and the trace export read. A frame runs
+// from beginFrame() to endFrame() and so leaves out time spent waiting for
+// input.
+class Profiler {
+public:
+    static const int HISTORY_FRAMES = 1024;
+    // One bin per millisecond; the last also takes every slower frame.
+    static const int HISTOGRAM_BINS = 32;
+    static const std::size_t HISTORY_EVENTS = 1 << 16;
+
+    struct FrameStats {
+        int frames = 0;
+        double p50Ms = 0;
+        double p90Ms = 0;
+        double p99Ms = 0;
+        double maxMs = 0;
+        int histogram[HISTOGRAM_BINS] = {};
+        // Per phase over the events still in the history.
+        double phaseMeanMs[static_cast<int>(ProfilePhase::Count)] = {};
+        double phaseMaxMs[static_cast<int>(ProfilePhase::Count)] = {};
+        uint64_t dropped = 0;
+    };
+
+private:
+    typedef std::chrono::steady_clock clock;
+    clock::time_point origin;
+    ProfileRing ring;
+    std::vector<ProfileEvent> history;
+    std::size_t historyNext = 0;
+    bool historyFull = false;
+    std::vector<float> frameMs;
+    std::size_t frameNext = 0;
+    int frameCount = 0;
+    uint64_t frameStart = 0;
+    bool inFrame = false;
+    // The thread that runs frames, named in the trace.
+    uint16_t frameThread = 0;
+
+public:
+    explicit Profiler(std::size_t ringCapacity = 1 << 14);
+
+    uint64_t now() const;
+    void record(ProfilePhase phase, uint64_t startNs, uint64_t endNs);
+    void beginFrame();
+    // Records the frame and collects the events pushed so far.
+    void endFrame();
+    // Moves pushed events into the history; game thread only, like the
+    // calls below.
+    void collect();
+    FrameStats frameStats() const;
+    // Writes the history as Chrome trace-event JSON, for chrome://tracing
+    // or Perfetto.
+    bool writeChromeTrace(const std::string& path);
+};
+
+// Records the time from its construction to the end of its scope.
+class ProfileScope {
+private:
+    Profiler& profiler;
+    ProfilePhase phase;
+    uint64_t start;
+
+public:
+    ProfileScope(Profiler& profiler, ProfilePhase phase) : profiler(profiler), phase(phase), start(profiler.now()) {}
+    ~ProfileScope() { profiler.record(phase, start, profiler.now()); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif
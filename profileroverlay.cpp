@@ -0,0 +1,52 @@
+#include "profileroverlay.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font) : text("", font, 12), bars(sf::Quads) {
+    panel.setFillColor(sf::Color(0, 0, 0, 190));
+    panel.setPosition(8, 8);
+    text.setFillColor(sf::Color::White);
+    text.setPosition(14, 12);
+}
+
+void ProfilerOverlay::setStats(const Profiler::FrameStats& stats) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << stats.frames << " frames  p50 " << stats.p50Ms << "  p90 " << stats.p90Ms << "  p99 " << stats.p99Ms
+        << "  max " << stats.maxMs << " ms\n";
+    // Waiting for input is idle time, so it is left out like in the frames.
+    for (int phase = static_cast<int>(ProfilePhase::Events); phase < static_cast<int>(ProfilePhase::Count); ++phase) {
+        out << profilePhaseName(static_cast<ProfilePhase>(phase)) << "  mean " << stats.phaseMeanMs[phase] << "  max "
+            << stats.phaseMaxMs[phase] << " ms\n";
+    }
+    if (stats.dropped > 0) out << stats.dropped << " events dropped\n";
+    text.setString(out.str());
+
+    sf::FloatRect bounds = text.getLocalBounds();
+    float histogramTop = text.getPosition().y + bounds.top + bounds.height + 8;
+    float width = std::max(bounds.width, static_cast<float>(Profiler::HISTOGRAM_BINS * BAR_WIDTH));
+    panel.setSize(sf::Vector2f(width + 12, histogramTop + HISTOGRAM_HEIGHT + 6 - panel.getPosition().y));
+
+    // One bar per millisecond bin, scaled to the fullest; red past 16 ms.
+    int most = *std::max_element(stats.histogram, stats.histogram + Profiler::HISTOGRAM_BINS);
+    bars.resize(Profiler::HISTOGRAM_BINS * 4);
+    float bottom = histogramTop + HISTOGRAM_HEIGHT;
+    for (int bin = 0; bin < Profiler::HISTOGRAM_BINS; ++bin) {
+        float height = most > 0 ? static_cast<float>(stats.histogram[bin]) / most * HISTOGRAM_HEIGHT : 0;
+        if (stats.histogram[bin] > 0) height = std::max(height, 1.0f);
+        float left = text.getPosition().x + bin * BAR_WIDTH;
+        sf::Color color = bin < 16 ? sf::Color(120, 200, 120) : sf::Color(220, 90, 90);
+        sf::Vertex* quad = &bars[bin * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(left, bottom - height), color);
+        quad[1] = sf::Vertex(sf::Vector2f(left + BAR_WIDTH - 1, bottom - height), color);
+        quad[2] = sf::Vertex(sf::Vector2f(left + BAR_WIDTH - 1, bottom), color);
+        quad[3] = sf::Vertex(sf::Vector2f(left, bottom), color);
+    }
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(panel, states);
+    target.draw(text, states);
+    target.draw(bars, states);
+}
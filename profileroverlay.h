@@ -0,0 +1,24 @@
+#ifndef MINESWEEPER_PROFILEROVERLAY_H
+#define MINESWEEPER_PROFILEROVERLAY_H
+
+#include <SFML/Graphics.hpp>
+#include "profiler.h"
+
+// Frame time percentiles, the slowest run of each phase and a histogram of
+// recent frame times, drawn in the top left corner of the window.
+class ProfilerOverlay : public sf::Drawable {
+private:
+    static const int BAR_WIDTH = 6;
+    static const int HISTOGRAM_HEIGHT = 48;
+
+    sf::RectangleShape panel;
+    sf::Text text;
+    sf::VertexArray bars;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+public:
+    explicit ProfilerOverlay(const sf::Font& font);
+    void setStats(const Profiler::FrameStats& stats);
+};
+
+#endif
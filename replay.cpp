@@ -0,0 +1,258 @@
+#include "replay.h"
+#include <algorithm>
+#include <limits>
+#include "binaryio.h"
+
+static const uint8_t REPLAY_VERSION = 1;
+static const uint32_t LOG_VERSION = 1;
+static const char LOG_MAGIC[] = "MSWR";
+static const std::size_t HEADER_SIZE = 8;
+static const std::size_t MAX_NAME_LENGTH = 1024;
+// Board indexes its cells with an int.
+static const uint64_t MAX_CELLS = 0x7fffffff;
+
+static std::string logHeader() {
+    std::string header(LOG_MAGIC, 4);
+    ByteWriter(header).u32(LOG_VERSION);
+    return header;
+}
+
+void encodeReplay(const Replay& replay, std::string& out) {
+    ByteWriter writer(out);
+    writer.u8(REPLAY_VERSION);
+    writer.text(replay.player);
+    writer.varint(static_cast<uint64_t>(replay.rows));
+    writer.varint(static_cast<uint64_t>(replay.columns));
+    writer.varint(static_cast<uint64_t>(replay.mines));
+    writer.u64(replay.seed);
+
+    std::vector<int> mineCells = replay.mineCells;
+    std::sort(mineCells.begin(), mineCells.end());
+    writer.varint(mineCells.size());
+    int previousCell = -1;
+    for (int cell : mineCells) {
+        writer.varint(static_cast<uint64_t>(cell - previousCell));
+        previousCell = cell;
+    }
+
+    uint32_t previousTime = 0;
+    for (const ReplayMove& move : replay.moves) {
+        writer.varint(move.timeMs - previousTime);
+        writer.varint(static_cast<uint64_t>(move.cell) << 2 | static_cast<uint8_t>(move.kind));
+        previousTime = move.timeMs;
+    }
+}
+
+bool decodeReplay(const char* data, std::size_t size, Replay& replay) {
+    ByteReader reader(data, size);
+    uint8_t version;
+    uint64_t rows, columns, mines, mineCount;
+    if (!reader.u8(version) || version != REPLAY_VERSION || !reader.text(replay.player, MAX_NAME_LENGTH) ||
+        !reader.varint(rows) || !reader.varint(columns) || !reader.varint(mines) || !reader.u64(replay.seed) ||
+        !reader.varint(mineCount)) {
+        return false;
+    }
+    if (rows == 0 || columns == 0 || rows > MAX_CELLS || columns > MAX_CELLS || rows * columns > MAX_CELLS ||
+        mines > rows * columns || (mineCount != 0 && mineCount != mines)) {
+        return false;
+    }
+    uint64_t cellCount = rows * columns;
+    replay.rows = static_cast<int>(rows);
+    replay.columns = static_cast<int>(columns);
+    replay.mines = static_cast<int>(mines);
+
+    replay.mineCells.clear();
+    uint64_t cell = static_cast<uint64_t>(-1);
+    for (uint64_t i = 0; i < mineCount; ++i) {
+        uint64_t gap;
+        if (!reader.varint(gap) || gap == 0 || gap > cellCount) return false;
+        cell += gap;
+        if (cell >= cellCount) return false;
+        replay.mineCells.push_back(static_cast<int>(cell));
+    }
+
+    replay.moves.clear();
+    uint64_t time = 0;
+    while (reader.remaining() > 0) {
+        uint64_t delta, packed;
+        if (!reader.varint(delta) || !reader.varint(packed)) return false;
+        time += delta;
+        uint64_t moveCell = packed >> 2;
+        uint8_t kind = packed & 3;
+        if (delta > std::numeric_limits<uint32_t>::max() || time > std::numeric_limits<uint32_t>::max() ||
+            moveCell >= cellCount || kind > static_cast<uint8_t>(MoveKind::Chord)) {
+            return false;
+        }
+        replay.moves.push_back(ReplayMove{static_cast<uint32_t>(time), static_cast<MoveKind>(kind),
+                                          static_cast<int>(moveCell)});
+    }
+    return true;
+}
+
+Board replayStartBoard(const Replay& replay) {
+    if (replay.mineCells.empty()) return Board(replay.rows, replay.columns, replay.mines, replay.seed);
+    return Board(replay.rows, replay.columns, replay.mineCells, replay.seed);
+}
+
+bool playReplayMove(Board& board, const ReplayMove& move) {
+    int x = move.cell % board.getColumns();
+    int y = move.cell / board.getColumns();
+    switch (move.kind) {
+        case MoveKind::Reveal:
+            return board.leftClick(x, y);
+        case MoveKind::Chord:
+            return board.chord(x, y);
+        case MoveKind::Flag:
+            board.rightClick(x, y);
+            break;
+    }
+    return false;
+}
+
+ReplayResult runReplay(const Replay& replay) {
+    Board board = replayStartBoard(replay);
+    ReplayResult result{GameState::Playing, 0, 0};
+    for (const ReplayMove& move : replay.moves) {
+        if (board.getGameState() != GameState::Playing) break;
+        playReplayMove(board, move);
+        result.timeMs = move.timeMs;
+        ++result.movesPlayed;
+    }
+    result.state = board.getGameState();
+    return result;
+}
+
+bool appendReplay(const std::string& path, const Replay& replay) {
+    std::FILE* log = std::fopen(path.c_str(), "ab");
+    if (!log) return false;
+    std::string payload;
+    encodeReplay(replay, payload);
+    std::string encoded;
+    // "ab" always writes at the end, so an empty file is a new log.
+    std::fseek(log, 0, SEEK_END);
+    if (std::ftell(log) == 0) encoded = logHeader();
+    writeFramed(encoded, payload);
+    bool written = std::fwrite(encoded.data(), 1, encoded.size(), log) == encoded.size() && syncFile(log);
+    return std::fclose(log) == 0 && written;
+}
+
+bool readReplayLog(const std::string& path, std::vector<Replay>& replays, bool& damaged) {
+    damaged = false;
+    std::vector<char> contents;
+    if (!readWholeFile(path, contents)) return false;
+    if (contents.size() < HEADER_SIZE || std::string(contents.data(), HEADER_SIZE) != logHeader()) return false;
+
+    ByteReader reader(contents.data() + HEADER_SIZE, contents.size() - HEADER_SIZE);
+    ByteReader payload(nullptr, 0);
+    Replay replay;
+    while (reader.remaining() > 0) {
+        if (!readFramed(reader, payload) || !decodeReplay(payload.current(), payload.remaining(), replay)) {
+            damaged = true;
+            break;
+        }
+        replays.push_back(replay);
+    }
+    return true;
+}
+
+bool repairReplayLog(const std::string& path) {
+    std::string intact;
+    {
+        MappedFile file;
+        // Nothing to repair in a missing or empty log.
+        if (!file.open(path)) return true;
+        if (file.size() < HEADER_SIZE || std::string(file.data(), HEADER_SIZE) != logHeader()) return false;
+        ByteReader reader(file.data() + HEADER_SIZE, file.size() - HEADER_SIZE);
+        ByteReader payload(nullptr, 0);
+        while (reader.remaining() > 0 && readFramed(reader, payload)) {}
+        if (reader.remaining() == 0) return true;
+        intact.assign(file.data(), reader.current());
+    }
+    // The mapping is closed first: Windows cannot replace a mapped file.
+    return writeFileAtomically(path, intact);
+}
+
+bool writeReplayLog(const std::string& path, const std::vector<Replay>& replays) {
+    std::string contents = logHeader();
+    std::string payload;
+    for (const Replay& replay : replays) {
+        payload.clear();
+        encodeReplay(replay, payload);
+        writeFramed(contents, payload);
+    }
+    return writeFileAtomically(path, contents);
+}
+
+void ReplayRecorder::start(Board& board, const GameClock& gameClock, const std::string& player, bool layoutFromSeed) {
+    clock = &gameClock;
+    replay.player = player;
+    replay.rows = board.getRows();
+    replay.columns = board.getColumns();
+    replay.mines = board.getMineCount();
+    replay.seed = board.getSeed();
+    replay.mineCells.clear();
+    replay.moves.clear();
+    for (int r = 0; r < replay.rows; ++r) {
+        for (int c = 0; c < replay.columns; ++c) {
+            int cell = r * replay.columns + c;
+            if (not layoutFromSeed && board.hasMine(r, c)) replay.mineCells.push_back(cell);
+            // An opened region floods back out from any empty cell inside it.
+            if (replay.moves.empty() && board.isRevealed(r, c) && not board.hasMine(r, c) &&
+                board.getAdjacentMines(r, c) == 0) {
+                replay.moves.push_back(ReplayMove{0, MoveKind::Reveal, cell});
+            }
+        }
+    }
+    board.setMoveListener(this);
+}
+
+void ReplayRecorder::resume(Board& board, const GameClock& gameClock, const Replay& saved) {
+    clock = &gameClock;
+    replay = saved;
+    board.setMoveListener(this);
+}
+
+const Replay& ReplayRecorder::current() const {
+    return replay;
+}
+
+void ReplayRecorder::moved(MoveKind kind, int cellIndex) {
+    uint32_t time = clock ? static_cast<uint32_t>(clock->elapsedMilliseconds()) : 0;
+    replay.moves.push_back(ReplayMove{time, kind, cellIndex});
+}
+
+ReplayPlayer::ReplayPlayer(const Replay& replay) : replay(replay), board(replayStartBoard(replay)) {}
+
+void ReplayPlayer::setSpeed(int multiplier) {
+    speed = std::max(1, std::min(multiplier, static_cast<int>(MAX_SPEED)));
+}
+
+int ReplayPlayer::getSpeed() const {
+    return speed;
+}
+
+void ReplayPlayer::advance(double wallMs) {
+    position += wallMs * speed;
+    while (nextMove < replay.moves.size() && replay.moves[nextMove].timeMs <= position) {
+        playReplayMove(board, replay.moves[nextMove]);
+        ++nextMove;
+    }
+}
+
+bool ReplayPlayer::finished() const {
+    return nextMove == replay.moves.size();
+}
+
+double ReplayPlayer::msUntilNextMove() const {
+    if (finished()) return 0;
+    return std::max(0.0, (replay.moves[nextMove].timeMs - position) / speed);
+}
+
+uint32_t ReplayPlayer::getTimeMs() const {
+    if (finished()) return replay.moves.empty() ? 0 : replay.moves.back().timeMs;
+    return static_cast<uint32_t>(position);
+}
+
+Board& ReplayPlayer::getBoard() {
+    return board;
+}
@@ -0,0 +1,109 @@
+#ifndef MINESWEEPER_REPLAY_H
+#define MINESWEEPER_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "gameclock.h"
+
+struct ReplayMove {
+    // Game clock time of the move.
+    uint32_t timeMs;
+    MoveKind kind;
+    int cell;
+};
+
+// One game as its starting board and every move made on it.
+struct Replay {
+    std::string player;
+    int rows = 0;
+    int columns = 0;
+    int mines = 0;
+    uint64_t seed = 0;
+    // Empty when the seed places the mines; otherwise the exact layout, as
+    // for no-guess boards.
+    std::vector<int> mineCells;
+    std::vector<ReplayMove> moves;
+};
+
+struct ReplayResult {
+    GameState state;
+    // Time of the last move played; for a won game, the winning time.
+    uint32_t timeMs;
+    int movesPlayed;
+};
+
+// Encoding, little-endian:
+//   u8 version, u32 name length, name, varint rows, columns, mines,
+//   u64 seed, varint mine count, each mine as a varint gap from the last,
+//   then to the end per move
+//   varint ms since the previous move, varint (cell << 2 | kind).
+// A move usually takes two to four bytes.
+void encodeReplay(const Replay& replay, std::string& out);
+bool decodeReplay(const char* data, std::size_t size, Replay& replay);
+
+Board replayStartBoard(const Replay& replay);
+// Plays one move on board and returns true if it won the game.
+bool playReplayMove(Board& board, const ReplayMove& move);
+// Plays the whole replay headless on a fresh board.
+ReplayResult runReplay(const Replay& replay);
+
+// Replay log: "MSWR", u32 version, then each replay framed by
+// writeFramed(). Appends are synced like the game log.
+bool appendReplay(const std::string& path, const Replay& replay);
+// Reads every intact replay in order. Returns false if the file cannot be
+// read or is not a replay log; damaged is set when a torn or corrupted
+// record ended the read early.
+bool readReplayLog(const std::string& path, std::vector<Replay>& replays, bool& damaged);
+// Cuts a torn or corrupted tail off the log, checking only each record's
+// length and checksum, so later appends stay readable. Returns true if the
+// log was intact, missing or repaired.
+bool repairReplayLog(const std::string& path);
+bool writeReplayLog(const std::string& path, const std::vector<Replay>& replays);
+
+// Records the moves made on a board, timed by the game clock, from start()
+// until the board is reset.
+class ReplayRecorder : public MoveListener {
+private:
+    Replay replay;
+    const GameClock* clock = nullptr;
+
+public:
+    // layoutFromSeed says whether board's seed alone rebuilds its mines;
+    // if not, the layout is stored. Cells already open, as on a no-guess
+    // board, are recorded as a move at time 0.
+    void start(Board& board, const GameClock& gameClock, const std::string& player, bool layoutFromSeed);
+    // Carries on recording a saved game from its replay so far.
+    void resume(Board& board, const GameClock& gameClock, const Replay& saved);
+    const Replay& current() const;
+    void moved(MoveKind kind, int cellIndex) override;
+};
+
+// Steps a replay forward in real time at 1x to 100x speed, for watching it.
+class ReplayPlayer {
+private:
+    Replay replay;
+    Board board;
+    std::size_t nextMove = 0;
+    double position = 0;
+    int speed = 1;
+
+public:
+    static const int MAX_SPEED = 100;
+
+    explicit ReplayPlayer(const Replay& replay);
+    void setSpeed(int multiplier);
+    int getSpeed() const;
+    // Moves on by wallMs of real time and plays the moves now due.
+    void advance(double wallMs);
+    bool finished() const;
+    // Real time until the next move is due; 0 once finished.
+    double msUntilNextMove() const;
+    // Game clock time reached so far.
+    uint32_t getTimeMs() const;
+    Board& getBoard();
+};
+
+#endif
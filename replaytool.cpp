@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "gamestore.h"
+#include "replay.h"
+
+// Headless replayer: plays back every game in a replay log and, given the
+// game log as well, checks each win against the time it was recorded with.
+// Usage: minesweeper_replay replays.log [games.log]
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " replays.log [games.log]" << std::endl;
+        return 2;
+    }
+    std::vector<Replay> replays;
+    bool damaged;
+    if (!readReplayLog(argv[1], replays, damaged)) {
+        std::cerr << "Not a readable replay log: " << argv[1] << std::endl;
+        return 1;
+    }
+    if (damaged) std::cerr << "Replay log has a damaged tail; read " << replays.size() << " replays" << std::endl;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<ReplayResult> results;
+    results.reserve(replays.size());
+    for (const Replay& replay : replays) {
+        results.push_back(runReplay(replay));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int won = 0, lost = 0, unfinished = 0;
+    for (const ReplayResult& result : results) {
+        if (result.state == GameState::Won) ++won;
+        else if (result.state == GameState::Lost) ++lost;
+        else ++unfinished;
+    }
+    std::cout << replays.size() << " replays: " << won << " won, " << lost << " lost, " << unfinished
+              << " unfinished in " << seconds * 1000 << " ms (" << (seconds > 0 ? replays.size() / seconds : 0)
+              << " replays/s)" << std::endl;
+    if (argc < 3) return 0;
+
+    // Only read the game log: GameStore::open() would create a missing one
+    // and rewrite a damaged one.
+    GameStore store;
+    bool storeDamaged;
+    if (!store.openReadOnly(argv[2], storeDamaged)) {
+        std::cerr << "Not a readable game log: " << argv[2] << std::endl;
+        return 1;
+    }
+    if (storeDamaged) std::cerr << "Game log has a damaged tail; read " << store.size() << " games" << std::endl;
+    // The game records a win with the time of its winning move, the same
+    // reading the replay holds, so the two must agree exactly.
+    const long long tolerance = 0;
+    std::vector<bool> used(store.size(), false);
+    int verified = 0, mismatched = 0;
+    for (std::size_t i = 0; i < replays.size(); ++i) {
+        if (results[i].state != GameState::Won) continue;
+        const Replay& replay = replays[i];
+        // The same board can be won more than once, so pair each replay with
+        // the unclaimed win on it closest in time.
+        long long best = -1;
+        long long bestDifference = 0;
+        for (uint32_t id : store.playerGames(replay.player)) {
+            const GameRecord& record = store.record(id);
+            if (used[id] || record.outcome != GameOutcome::Won || record.seed != replay.seed ||
+                record.config.rows != replay.rows || record.config.columns != replay.columns ||
+                record.config.mines != replay.mines) {
+                continue;
+            }
+            long long difference = std::llabs(static_cast<long long>(record.timeMs) - results[i].timeMs);
+            if (best < 0 || difference < bestDifference) {
+                best = id;
+                bestDifference = difference;
+            }
+        }
+        if (best < 0) {
+            ++mismatched;
+            std::cout << "replay " << i << " (" << replay.player << "): no recorded win for this board" << std::endl;
+            continue;
+        }
+        used[best] = true;
+        if (bestDifference <= tolerance) {
+            ++verified;
+        } else {
+            ++mismatched;
+            std::cout << "replay " << i << " (" << replay.player << ", seed " << std::hex << replay.seed << std::dec
+                      << "): recorded " << store.record(static_cast<uint32_t>(best)).timeMs << " ms, replayed "
+                      << results[i].timeMs << " ms" << std::endl;
+        }
+    }
+    std::cout << verified << " of " << won << " wins match the game log" << std::endl;
+    return mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#ifndef MINESWEEPER_RNG_H
+#define MINESWEEPER_RNG_H
+
+#include <cstdint>
+#include <random>
+
+// Advances a splitmix64 state and returns the next output. Used to expand
+// one 64-bit seed into generator state and to derive further seeds.
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// A fresh seed from the system's entropy source.
+inline uint64_t randomSeed() {
+    std::random_device entropy;
+    return (static_cast<uint64_t>(entropy()) << 32) ^ entropy();
+}
+
+// xoshiro256** generator. The <random> distributions differ between
+// standard libraries, so boards draw from this directly: the same seed
+// gives the same board on every platform.
+class Rng {
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    explicit Rng(uint64_t seed) {
+        for (uint64_t& word : state) {
+            word = splitmix64(seed);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound) for bound > 0, rejecting the low values that
+    // would otherwise bias the modulo.
+    uint64_t below(uint64_t bound) {
+        uint64_t threshold = (0 - bound) % bound;
+        uint64_t value;
+        do {
+            value = next();
+        } while (value < threshold);
+        return value % bound;
+    }
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "savegame.h"
+#include <cstdio>
+#include <iostream>
+#include <utility>
+#include "binaryio.h"
+
+static const char SAVE_MAGIC[] = "MSWS";
+static const uint32_t SAVE_VERSION = 1;
+static const std::size_t CELL_ALIGNMENT = 64;
+// Everything before the header checksum.
+static const std::size_t HEADER_FIELDS_SIZE = 74;
+
+bool writeSavedGame(const std::string& path, const SavedGame& game) {
+    const BoardSnapshot& board = game.board;
+    std::string replay;
+    encodeReplay(game.replay, replay);
+    const char* cells = reinterpret_cast<const char*>(board.cells.data());
+    uint64_t cellsOffset = (HEADER_FIELDS_SIZE + 4 + CELL_ALIGNMENT - 1) / CELL_ALIGNMENT * CELL_ALIGNMENT;
+
+    std::string contents(SAVE_MAGIC, 4);
+    contents.reserve(cellsOffset + board.cells.size() + replay.size());
+    ByteWriter writer(contents);
+    writer.u32(SAVE_VERSION);
+    writer.u32(static_cast<uint32_t>(board.rows));
+    writer.u32(static_cast<uint32_t>(board.columns));
+    writer.u32(static_cast<uint32_t>(board.mines));
+    writer.u64(board.seed);
+    writer.u64(static_cast<uint64_t>(game.elapsedMs));
+    writer.u8(static_cast<uint8_t>(board.state));
+    writer.u8(board.paused ? 1 : 0);
+    writer.u32(static_cast<uint32_t>(board.revealed));
+    writer.u32(static_cast<uint32_t>(board.flagsPlaced));
+    writer.u32(static_cast<uint32_t>(board.correctFlags));
+    writer.u64(cellsOffset);
+    writer.u64(checksum64(cells, board.cells.size()));
+    writer.u32(static_cast<uint32_t>(replay.size()));
+    writer.u32(checksum32(replay.data(), replay.size()));
+    writer.u32(checksum32(contents.data(), contents.size()));
+    contents.resize(cellsOffset, '\0');
+    writer.bytes(cells, board.cells.size());
+    contents += replay;
+    return writeFileAtomically(path, contents);
+}
+
+bool loadSavedGame(const std::string& path, Board& board, long long& elapsedMs, Replay& replay) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < HEADER_FIELDS_SIZE + 4) return false;
+
+    ByteReader reader(file.data(), file.size());
+    std::string magic;
+    uint32_t version, rows, columns, mines, revealed, flagsPlaced, correctFlags, replaySize, replayChecksum, headerChecksum;
+    uint64_t elapsed, cellsOffset, cellsChecksum;
+    uint8_t state, paused;
+    BoardSnapshot saved;
+    if (!reader.bytes(4, magic) || magic != SAVE_MAGIC || !reader.u32(version) || version != SAVE_VERSION ||
+        !reader.u32(rows) || !reader.u32(columns) || !reader.u32(mines) || !reader.u64(saved.seed) ||
+        !reader.u64(elapsed) || !reader.u8(state) || !reader.u8(paused) || !reader.u32(revealed) ||
+        !reader.u32(flagsPlaced) || !reader.u32(correctFlags) || !reader.u64(cellsOffset) ||
+        !reader.u64(cellsChecksum) || !reader.u32(replaySize) || !reader.u32(replayChecksum) ||
+        !reader.u32(headerChecksum) || headerChecksum != checksum32(file.data(), HEADER_FIELDS_SIZE)) {
+        return false;
+    }
+
+    // The header checksum rules out damage; these rule out nonsense.
+    uint64_t cellCount = static_cast<uint64_t>(rows) * columns;
+    if (rows == 0 || columns == 0 || cellCount > 0x7fffffff || mines > cellCount ||
+        state > static_cast<uint8_t>(GameState::Lost) || revealed > cellCount - mines || flagsPlaced > cellCount ||
+        correctFlags > flagsPlaced || correctFlags > mines || cellsOffset < reader.offset() ||
+        cellsOffset > file.size() || cellCount > file.size() - cellsOffset ||
+        replaySize != file.size() - cellsOffset - cellCount) {
+        return false;
+    }
+    const char* cells = file.data() + cellsOffset;
+    const char* replayBytes = cells + cellCount;
+    if (checksum64(cells, cellCount) != cellsChecksum || checksum32(replayBytes, replaySize) != replayChecksum ||
+        !decodeReplay(replayBytes, replaySize, replay)) {
+        return false;
+    }
+
+    saved.rows = static_cast<int>(rows);
+    saved.columns = static_cast<int>(columns);
+    saved.mines = static_cast<int>(mines);
+    saved.state = static_cast<GameState>(state);
+    saved.paused = paused != 0;
+    saved.revealed = static_cast<int>(revealed);
+    saved.flagsPlaced = static_cast<int>(flagsPlaced);
+    saved.correctFlags = static_cast<int>(correctFlags);
+    board.restore(saved, reinterpret_cast<const uint8_t*>(cells));
+    elapsedMs = static_cast<long long>(elapsed);
+    return true;
+}
+
+AutoSaver::AutoSaver(const std::string& savePath) : path(savePath) {
+    worker = std::thread(&AutoSaver::workerLoop, this);
+}
+
+AutoSaver::~AutoSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AutoSaver::save(const Board& board, long long elapsedMs, const Replay& replay) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        board.snapshot(pending.board);
+        pending.elapsedMs = elapsedMs;
+        pending.replay = replay;
+        savePending = true;
+    }
+    wake.notify_one();
+}
+
+void AutoSaver::discard() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        savePending = false;
+        discardPending = true;
+    }
+    wake.notify_one();
+}
+
+void AutoSaver::workerLoop() {
+    while (true) {
+        bool saving, discarding;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || savePending || discardPending; });
+            if (!savePending && !discardPending) return;
+            saving = savePending;
+            discarding = discardPending;
+            // Swapping keeps both buffers' storage for the next save.
+            if (saving) std::swap(pending, writing);
+            savePending = false;
+            discardPending = false;
+        }
+
+        // A discard was asked for before any save still queued.
+        if (discarding) std::remove(path.c_str());
+        if (saving && !writeSavedGame(path, writing)) {
+            std::cerr << "Could not autosave to " << path << std::endl;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef MINESWEEPER_SAVEGAME_H
+#define MINESWEEPER_SAVEGAME_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "board.h"
+#include "replay.h"
+
+// A game in progress: the board, the clock and the moves so far.
+struct SavedGame {
+    BoardSnapshot board;
+    long long elapsedMs = 0;
+    Replay replay;
+};
+
+// Save file, little-endian:
+//   "MSWS", u32 version, u32 rows, u32 columns, u32 mines, u64 seed,
+//   u64 elapsed ms, u8 state, u8 paused, u32 revealed, u32 flags placed,
+//   u32 correct flags, u64 cells offset, u64 checksum64(cells),
+//   u32 replay size, u32 checksum32(replay), u32 checksum32(header so far)
+// then zero padding up to the cells offset, a multiple of 64, the cells
+// in Board's encoding and last the encodeReplay() bytes. The cells are
+// copied straight out of the mapped file on load, never parsed.
+bool writeSavedGame(const std::string& path, const SavedGame& game);
+// Restores board from the file at path. Returns false, leaving board
+// alone, if there is no save or it fails any check.
+bool loadSavedGame(const std::string& path, Board& board, long long& elapsedMs, Replay& replay);
+
+// Writes saves on its own thread. save() only copies the game, so the
+// frame loop never waits for the disk; a newer save replaces one not yet
+// written. Requests are carried out in order, and any still queued are
+// finished before the destructor returns.
+class AutoSaver {
+private:
+    std::string path;
+    SavedGame pending;
+    SavedGame writing;
+    bool savePending = false;
+    bool discardPending = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    // Declared last so everything above exists before the worker starts.
+    std::thread worker;
+
+    void workerLoop();
+public:
+    explicit AutoSaver(const std::string& savePath);
+    ~AutoSaver();
+    AutoSaver(const AutoSaver&) = delete;
+    AutoSaver& operator=(const AutoSaver&) = delete;
+
+    void save(const Board& board, long long elapsedMs, const Replay& replay);
+    // Deletes the save, e.g. once its game is over.
+    void discard();
+};
+
+#endif
@@ -0,0 +1,426 @@
+#include "solver.h"
+#include <algorithm>
+#include <cmath>
+
+// overlap[(dy + 2) * 5 + dx + 2][mask] re-expresses a 3x3 neighbour mask
+// around one cell as a mask around the cell dy rows and dx columns away,
+// dropping the neighbours the two cells do not share.
+struct OverlapTable {
+    uint8_t overlap[25][256];
+
+    OverlapTable() {
+        static const int dy[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+        static const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+        for (int ry = -2; ry <= 2; ++ry) {
+            for (int rx = -2; rx <= 2; ++rx) {
+                uint8_t* row = overlap[(ry + 2) * 5 + rx + 2];
+                for (int mask = 0; mask < 256; ++mask) {
+                    row[mask] = 0;
+                    for (int k = 0; k < 8; ++k) {
+                        if (not (mask & (1 << k))) continue;
+                        for (int j = 0; j < 8; ++j) {
+                            if (dy[k] - ry == dy[j] && dx[k] - rx == dx[j]) row[mask] |= 1 << j;
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+static const OverlapTable& overlapTable() {
+    static const OverlapTable table;
+    return table;
+}
+
+static int bitCount(unsigned mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) ++count;
+    return count;
+}
+
+Solver::Solver(const Board& board) : board(&board) {
+    reset();
+}
+
+// Forgets all deductions and reloads the revealed cells of the board.
+void Solver::reset() {
+    rows = board->getRows();
+    columns = board->getColumns();
+    stride = columns + 2;
+    int k = 0;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dy != 0 || dx != 0) offsets[k++] = dy * stride + dx;
+        }
+    }
+
+    std::size_t size = static_cast<std::size_t>(rows + 2) * stride;
+    grid.assign(size, static_cast<uint8_t>(OUTSIDE));
+    queued.assign(size, 0);
+    isOpen.assign(size, 0);
+    touched.assign(size, 0);
+    variableOf.assign(size, -1);
+    worklist.clear();
+    safeCells.clear();
+    mineCells.clear();
+    openConstraints.clear();
+    nextSafe = 0;
+
+    std::vector<int> revealed;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            grid[(row + 1) * stride + col + 1] = 0;
+            if (board->isRevealed(row, col)) revealed.push_back(row * columns + col);
+        }
+    }
+    cellsRevealed(revealed);
+}
+
+void Solver::enqueueAround(int p) {
+    if ((grid[p] & REVEALED) && not queued[p]) {
+        queued[p] = 1;
+        worklist.push_back(p);
+    }
+    for (int offset : offsets) {
+        int q = p + offset;
+        if ((grid[q] & REVEALED) && not queued[q]) {
+            queued[q] = 1;
+            worklist.push_back(q);
+        }
+    }
+}
+
+// Collects the still-undecided hidden neighbours of a revealed number and
+// how many mines remain among them. Returns false if there are none.
+bool Solver::gather(int p, Constraint& constraint) const {
+    constraint.center = p;
+    constraint.remaining = grid[p] & NUMBER_MASK;
+    constraint.size = 0;
+    constraint.mask = 0;
+    for (int k = 0; k < 8; ++k) {
+        int q = p + offsets[k];
+        uint8_t status = grid[q];
+        if (status & MINE) {
+            --constraint.remaining;
+        } else if (status == 0) {
+            constraint.cells[constraint.size++] = q;
+            constraint.mask |= 1u << k;
+        }
+    }
+    return constraint.size > 0;
+}
+
+void Solver::markSafe(int p) {
+    if (grid[p] != 0) return;
+    grid[p] = SAFE;
+    ++deductions;
+    safeCells.push_back(unpadded(p));
+    enqueueAround(p);
+}
+
+void Solver::markMine(int p) {
+    if (grid[p] != 0) return;
+    grid[p] = MINE;
+    ++deductions;
+    mineCells.push_back(unpadded(p));
+    enqueueAround(p);
+}
+
+// With I the cells shared by a and b, the mines in I are bounded by both
+// constraints. Whatever range that leaves for b's own cells may force
+// them all safe or all mines. aInB is a's mask seen from b's centre.
+void Solver::applyPair(const Constraint& a, const Constraint& b, unsigned aInB) {
+    unsigned onlyB = b.mask & ~aInB;
+    int shared = bitCount(b.mask & aInB);
+    if (shared == 0 || onlyB == 0) return;
+
+    int onlyBSize = bitCount(onlyB);
+    int onlyASize = a.size - shared;
+    int sharedMinesMax = std::min(shared, std::min(a.remaining, b.remaining));
+    int sharedMinesMin = std::max(a.remaining - onlyASize, 0);
+
+    bool safe = b.remaining - sharedMinesMin == 0;
+    bool mine = b.remaining - sharedMinesMax == onlyBSize;
+    if (not safe && not mine) return;
+    for (int k = 0; k < 8; ++k) {
+        if (not (onlyB & (1u << k))) continue;
+        if (safe) markSafe(b.center + offsets[k]);
+        else markMine(b.center + offsets[k]);
+    }
+}
+
+void Solver::process(int p) {
+    touched[p] = 1;
+    Constraint a;
+    if (not gather(p, a)) return;
+
+    if (a.remaining == 0) {
+        for (int i = 0; i < a.size; ++i) markSafe(a.cells[i]);
+        return;
+    }
+    if (a.remaining == a.size) {
+        for (int i = 0; i < a.size; ++i) markMine(a.cells[i]);
+        return;
+    }
+
+    // Any constraint sharing a hidden cell with this one lies within one
+    // cell of the box around this constraint's unknowns. The padding keeps
+    // that box inside the grid.
+    int top = a.cells[0] / stride, bottom = top;
+    int left = a.cells[0] % stride, right = left;
+    for (int i = 1; i < a.size; ++i) {
+        int r = a.cells[i] / stride;
+        int c = a.cells[i] % stride;
+        top = std::min(top, r);
+        bottom = std::max(bottom, r);
+        left = std::min(left, c);
+        right = std::max(right, c);
+    }
+    const OverlapTable& table = overlapTable();
+    int centerRow = p / stride;
+    int centerCol = p % stride;
+    for (int ny = top - 1; ny <= bottom + 1; ++ny) {
+        for (int nx = left - 1; nx <= right + 1; ++nx) {
+            int other = ny * stride + nx;
+            if (other == p || not (grid[other] & REVEALED)) continue;
+            Constraint b;
+            if (not gather(other, b)) continue;
+            int ry = ny - centerRow;
+            int rx = nx - centerCol;
+            int before = deductions;
+            applyPair(a, b, table.overlap[(ry + 2) * 5 + rx + 2][a.mask]);
+            applyPair(b, a, table.overlap[(2 - ry) * 5 + 2 - rx][b.mask]);
+            if (deductions != before && not gather(p, a)) return;
+        }
+    }
+
+    if (not isOpen[p]) {
+        isOpen[p] = 1;
+        openConstraints.push_back(p);
+    }
+}
+
+static int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Groups the constraints still left open by process() into components
+// that share unknowns and row-reduces each one that changed. Returns true
+// if anything new was deduced.
+bool Solver::solveLinear() {
+    bool anyTouched = false;
+    for (int p : openConstraints) {
+        if (touched[p]) {
+            anyTouched = true;
+            break;
+        }
+    }
+    if (not anyTouched) return false;
+
+    stillOpen.clear();
+    variables.clear();
+    parent.clear();
+    componentOf.clear();
+    for (int p : openConstraints) {
+        Constraint constraint;
+        if (not gather(p, constraint)) {
+            isOpen[p] = 0;
+            continue;
+        }
+        stillOpen.push_back(p);
+        int root = -1;
+        for (int i = 0; i < constraint.size; ++i) {
+            int cell = constraint.cells[i];
+            if (variableOf[cell] < 0) {
+                variableOf[cell] = static_cast<int>(variables.size());
+                variables.push_back(cell);
+                parent.push_back(variableOf[cell]);
+            }
+            int r = findRoot(parent, variableOf[cell]);
+            if (root < 0) root = r;
+            else parent[r] = root;
+        }
+        componentOf.push_back(variableOf[constraint.cells[0]]);
+    }
+    openConstraints.swap(stillOpen);
+
+    constraintOrder.resize(openConstraints.size());
+    for (std::size_t i = 0; i < constraintOrder.size(); ++i) {
+        constraintOrder[i] = static_cast<int>(i);
+        componentOf[i] = findRoot(parent, componentOf[i]);
+    }
+    std::sort(constraintOrder.begin(), constraintOrder.end(), [&](int a, int b) { return componentOf[a] < componentOf[b]; });
+
+    variableRoot.resize(variables.size());
+    variableOrder.resize(variables.size());
+    for (std::size_t v = 0; v < variables.size(); ++v) {
+        variableRoot[v] = findRoot(parent, static_cast<int>(v));
+        variableOrder[v] = static_cast<int>(v);
+    }
+    std::sort(variableOrder.begin(), variableOrder.end(), [&](int a, int b) { return variableRoot[a] < variableRoot[b]; });
+    for (int cell : variables) variableOf[cell] = -1;
+
+    bool progress = false;
+    std::size_t variableBegin = 0;
+    for (std::size_t begin = 0; begin < constraintOrder.size();) {
+        int component = componentOf[constraintOrder[begin]];
+        bool changed = false;
+        componentConstraints.clear();
+        while (begin < constraintOrder.size() && componentOf[constraintOrder[begin]] == component) {
+            int p = openConstraints[constraintOrder[begin]];
+            if (touched[p]) changed = true;
+            touched[p] = 0;
+            componentConstraints.push_back(p);
+            ++begin;
+        }
+        componentVariables.clear();
+        while (variableBegin < variableOrder.size() && variableRoot[variableOrder[variableBegin]] == component) {
+            componentVariables.push_back(variables[variableOrder[variableBegin]]);
+            ++variableBegin;
+        }
+        if (changed && static_cast<int>(componentVariables.size()) <= MAX_LINEAR_VARIABLES) {
+            if (reduceComponent()) progress = true;
+        }
+    }
+    return progress;
+}
+
+// Gauss-Jordan elimination over the component in componentConstraints
+// and componentVariables. In a reduced row the unknowns are 0 or 1, so
+// its value lies between the sum of its negative and the sum of its
+// positive coefficients; a right-hand side at either end fixes every
+// unknown in the row.
+bool Solver::reduceComponent() {
+    const double epsilon = 1e-9;
+    std::size_t height = componentConstraints.size();
+    std::size_t width = componentVariables.size() + 1;
+    matrix.assign(height * width, 0.0);
+    for (std::size_t v = 0; v < componentVariables.size(); ++v) variableOf[componentVariables[v]] = static_cast<int>(v);
+    for (std::size_t row = 0; row < height; ++row) {
+        Constraint constraint;
+        gather(componentConstraints[row], constraint);
+        double* line = &matrix[row * width];
+        for (int i = 0; i < constraint.size; ++i) line[variableOf[constraint.cells[i]]] = 1.0;
+        line[width - 1] = constraint.remaining;
+    }
+    for (int cell : componentVariables) variableOf[cell] = -1;
+
+    std::size_t pivotRow = 0;
+    for (std::size_t col = 0; col + 1 < width && pivotRow < height; ++col) {
+        std::size_t best = pivotRow;
+        for (std::size_t row = pivotRow + 1; row < height; ++row) {
+            if (std::fabs(matrix[row * width + col]) > std::fabs(matrix[best * width + col])) best = row;
+        }
+        if (std::fabs(matrix[best * width + col]) < epsilon) continue;
+        if (best != pivotRow) {
+            std::swap_ranges(matrix.begin() + best * width, matrix.begin() + (best + 1) * width, matrix.begin() + pivotRow * width);
+        }
+        double* pivot = &matrix[pivotRow * width];
+        double scale = pivot[col];
+        for (std::size_t k = col; k < width; ++k) pivot[k] /= scale;
+        for (std::size_t row = 0; row < height; ++row) {
+            if (row == pivotRow) continue;
+            double* line = &matrix[row * width];
+            double factor = line[col];
+            if (std::fabs(factor) < epsilon) continue;
+            for (std::size_t k = col; k < width; ++k) line[k] -= factor * pivot[k];
+        }
+        ++pivotRow;
+    }
+
+    bool progress = false;
+    for (std::size_t row = 0; row < pivotRow; ++row) {
+        const double* line = &matrix[row * width];
+        double low = 0.0;
+        double high = 0.0;
+        for (std::size_t k = 0; k + 1 < width; ++k) {
+            if (line[k] > epsilon) high += line[k];
+            else if (line[k] < -epsilon) low += line[k];
+        }
+        double rhs = line[width - 1];
+        bool atLow = std::fabs(rhs - low) < epsilon;
+        bool atHigh = std::fabs(rhs - high) < epsilon;
+        if (not atLow && not atHigh) continue;
+        for (std::size_t k = 0; k + 1 < width; ++k) {
+            int cell = componentVariables[k];
+            if (std::fabs(line[k]) < epsilon || grid[cell] != 0) continue;
+            if ((line[k] > 0) == atHigh) markMine(cell);
+            else markSafe(cell);
+            progress = true;
+        }
+    }
+    return progress;
+}
+
+// Tells the solver which board cells were revealed since it last looked.
+void Solver::cellsRevealed(const std::vector<int>& cells) {
+    for (int cellIndex : cells) {
+        int p = padded(cellIndex);
+        int row = cellIndex / columns;
+        int col = cellIndex % columns;
+        if (board->hasMine(row, col)) {
+            grid[p] = MINE;
+            continue;
+        }
+        grid[p] = REVEALED | static_cast<uint8_t>(board->getAdjacentMines(row, col));
+        enqueueAround(p);
+    }
+}
+
+void Solver::solve() {
+    do {
+        while (!worklist.empty()) {
+            int p = worklist.back();
+            worklist.pop_back();
+            queued[p] = 0;
+            process(p);
+        }
+    } while (solveLinear());
+}
+
+bool Solver::isSafe(int row, int col) const {
+    return grid[(row + 1) * stride + col + 1] & SAFE;
+}
+
+bool Solver::isMine(int row, int col) const {
+    return grid[(row + 1) * stride + col + 1] & MINE;
+}
+
+// Hands out deduced safe cells that are still hidden, each once.
+bool Solver::nextSafeCell(int& cellIndex) {
+    while (nextSafe < safeCells.size()) {
+        int candidate = safeCells[nextSafe++];
+        if (not board->isRevealed(candidate / columns, candidate % columns)) {
+            cellIndex = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<int>& Solver::getSafeCells() const {
+    return safeCells;
+}
+
+const std::vector<int>& Solver::getMineCells() const {
+    return mineCells;
+}
+
+bool autoPlay(Board& board, Solver& solver) {
+    int columns = board.getColumns();
+    int cellIndex;
+    solver.solve();
+    while (board.getGameState() == GameState::Playing && solver.nextSafeCell(cellIndex)) {
+        do {
+            board.leftClick(cellIndex % columns, cellIndex / columns);
+            solver.cellsRevealed(board.getLastRevealed());
+        } while (board.getGameState() == GameState::Playing && solver.nextSafeCell(cellIndex));
+        solver.solve();
+    }
+    return board.getGameState() == GameState::Won;
+}
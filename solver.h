@@ -0,0 +1,97 @@
+#ifndef MINESWEEPER_SOLVER_H
+#define MINESWEEPER_SOLVER_H
+
+#include <cstdint>
+#include <vector>
+#include "board.h"
+
+// Finds cells that are provably safe or provably mines using only the
+// revealed numbers; the player's flags are never trusted. Each revealed
+// number is a constraint "k of these hidden neighbours are mines". A
+// constraint is checked on its own and against every constraint it
+// overlaps, bounding the mines in the shared cells (this covers the
+// subset rule). Work is incremental: only constraints around cells that
+// changed since the last solve() are re-examined. When those local rules
+// run dry, each connected group of open constraints is row-reduced as a
+// linear system over 0/1 unknowns; groups in which no constraint changed
+// since the previous pass are skipped.
+class Solver {
+private:
+    // Status of each cell in a grid padded by one cell on every side, so
+    // neighbours are fixed offsets with no bounds checks. A revealed cell
+    // keeps its number in the low bits.
+    static const uint8_t SAFE = 1 << 4;
+    static const uint8_t MINE = 1 << 5;
+    static const uint8_t REVEALED = 1 << 6;
+    static const uint8_t OUTSIDE = 1 << 7;
+    static const uint8_t NUMBER_MASK = 0x0F;
+
+    // Bit k of mask is set when the neighbour at offsets[k] is in cells.
+    struct Constraint {
+        int center;
+        int remaining;
+        int size;
+        unsigned mask;
+        int cells[8];
+    };
+
+    const Board* board;
+    int rows;
+    int columns;
+    int stride;
+    int offsets[8];
+    std::vector<uint8_t> grid;
+    std::vector<uint8_t> queued;
+    std::vector<int> worklist;
+    std::vector<int> safeCells;
+    std::vector<int> mineCells;
+    std::vector<int> openConstraints;
+    std::vector<uint8_t> isOpen;
+    std::vector<uint8_t> touched;
+    std::vector<int> variableOf;
+
+    // Scratch space reused by solveLinear() so it does not allocate per call.
+    std::vector<int> stillOpen;
+    std::vector<int> variables;
+    std::vector<int> parent;
+    std::vector<int> componentOf;
+    std::vector<int> constraintOrder;
+    std::vector<int> variableRoot;
+    std::vector<int> variableOrder;
+    std::vector<int> componentConstraints;
+    std::vector<int> componentVariables;
+    std::vector<double> matrix;
+    std::size_t nextSafe = 0;
+    int deductions = 0;
+
+    int padded(int cellIndex) const { return (cellIndex / columns + 1) * stride + cellIndex % columns + 1; }
+    int unpadded(int p) const { return (p / stride - 1) * columns + p % stride - 1; }
+    void enqueueAround(int p);
+    bool gather(int p, Constraint& constraint) const;
+    void markSafe(int p);
+    void markMine(int p);
+    void applyPair(const Constraint& a, const Constraint& b, unsigned aInB);
+    void process(int p);
+    bool solveLinear();
+    bool reduceComponent();
+public:
+    // Components with more unknowns than this are left to the local rules.
+    static const int MAX_LINEAR_VARIABLES = 256;
+
+    explicit Solver(const Board& board);
+    void reset();
+    void cellsRevealed(const std::vector<int>& cells);
+    void solve();
+    bool isSafe(int row, int col) const;
+    bool isMine(int row, int col) const;
+    bool nextSafeCell(int& cellIndex);
+    const std::vector<int>& getSafeCells() const;
+    const std::vector<int>& getMineCells() const;
+};
+
+// Reveals every cell the solver can prove safe, re-solving after each
+// batch of reveals, until the board is won or no certain move is left.
+// Returns true if the board ends up won.
+bool autoPlay(Board& board, Solver& solver);
+
+#endif
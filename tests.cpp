@@ -0,0 +1,232 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "gamestore.h"
+#include "probability.h"
+#include "replay.h"
+#include "savegame.h"
+#include "solver.h"
+#include "threadpool.h"
+
+// Checks of the core library on small fixed boards and files, for ctest.
+// Files are written to the working directory and removed again.
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            ++failures; \
+        } \
+    } while (false)
+
+// 3x3 with mines in two opposite corners. Opening (0, 1) and then (0, 2)
+// floods to leave
+//     ? 1 0
+//     ? 2 1
+//     ? ? ?
+// where each 1 puts one mine in its pair of hidden cells and the 2 then
+// proves (2, 0) safe.
+static Board cornerBoard() {
+    Board board(3, 3, std::vector<int>{0, 8});
+    board.leftClick(1, 0);
+    board.leftClick(2, 0);
+    return board;
+}
+
+static void testSolver() {
+    Board board = cornerBoard();
+    CHECK(board.getGameState() == GameState::Playing);
+    Solver solver(board);
+    solver.solve();
+    CHECK(solver.isSafe(2, 0));
+    CHECK(solver.getSafeCells() == std::vector<int>{6});
+    CHECK(solver.getMineCells().empty());
+    for (int cell : {0, 3, 7, 8}) {
+        CHECK(not solver.isSafe(cell / 3, cell % 3) && not solver.isMine(cell / 3, cell % 3));
+    }
+
+    CHECK(autoPlay(board, solver));
+    CHECK(board.getGameState() == GameState::Won);
+}
+
+static void testProbabilities() {
+    Board board = cornerBoard();
+    ThreadPool pool(2);
+    std::vector<double> probabilities = computeMineProbabilities(board, pool);
+    CHECK(probabilities.size() == 9);
+    const double expected[9] = {0.5, 0, 0, 0.5, 0, 0, 0, 0.5, 0.5};
+    for (int cell = 0; cell < 9; ++cell) {
+        CHECK(std::fabs(probabilities[cell] - expected[cell]) < 1e-9);
+    }
+}
+
+static Replay cornerReplay() {
+    Replay replay;
+    replay.player = "tester";
+    replay.rows = 3;
+    replay.columns = 3;
+    replay.mines = 2;
+    replay.seed = 0x0123456789ABCDEFull;
+    replay.mineCells = {0, 8};
+    replay.moves = {{0, MoveKind::Reveal, 1}, {250, MoveKind::Flag, 0}, {900, MoveKind::Reveal, 2},
+                    {70000, MoveKind::Reveal, 6}};
+    return replay;
+}
+
+static void testReplay() {
+    Replay replay = cornerReplay();
+    std::string encoded;
+    encodeReplay(replay, encoded);
+    Replay decoded;
+    CHECK(decodeReplay(encoded.data(), encoded.size(), decoded));
+    CHECK(decoded.player == replay.player);
+    CHECK(decoded.rows == 3 && decoded.columns == 3 && decoded.mines == 2);
+    CHECK(decoded.seed == replay.seed);
+    CHECK(decoded.mineCells == replay.mineCells);
+    CHECK(decoded.moves.size() == replay.moves.size());
+    for (std::size_t i = 0; i < decoded.moves.size() && i < replay.moves.size(); ++i) {
+        CHECK(decoded.moves[i].timeMs == replay.moves[i].timeMs);
+        CHECK(decoded.moves[i].kind == replay.moves[i].kind);
+        CHECK(decoded.moves[i].cell == replay.moves[i].cell);
+    }
+    CHECK(not decodeReplay(encoded.data(), encoded.size() / 2, decoded));
+
+    ReplayResult result = runReplay(replay);
+    CHECK(result.state == GameState::Won);
+    CHECK(result.timeMs == 70000);
+    CHECK(result.movesPlayed == 4);
+}
+
+static bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return static_cast<bool>(in) || in.eof();
+}
+
+static bool writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(out.flush());
+}
+
+static void testReplayLog() {
+    const std::string path = "tests_replays.log";
+    std::remove(path.c_str());
+    Replay replay = cornerReplay();
+    CHECK(repairReplayLog(path));
+    for (int i = 0; i < 3; ++i) CHECK(appendReplay(path, replay));
+    std::string contents;
+    CHECK(readFile(path, contents));
+    CHECK(writeFile(path, contents.substr(0, contents.size() - 3)));
+
+    // Without the repair the fourth replay would sit behind the torn third.
+    CHECK(repairReplayLog(path));
+    CHECK(appendReplay(path, replay));
+    std::vector<Replay> replays;
+    bool damaged;
+    CHECK(readReplayLog(path, replays, damaged));
+    CHECK(not damaged);
+    CHECK(replays.size() == 3);
+    std::string intact;
+    CHECK(readFile(path, intact));
+    CHECK(repairReplayLog(path));
+    CHECK(readFile(path, contents) && contents == intact);
+    std::remove(path.c_str());
+}
+
+static void testGameStore() {
+    const std::string path = "tests_games.log";
+    std::remove(path.c_str());
+    uint32_t id;
+    {
+        GameStore store;
+        CHECK(store.open(path));
+        for (uint64_t seed = 1; seed <= 3; ++seed) {
+            CHECK(store.append(GameRecord{"tester", BoardConfig{9, 9, 10}, seed, seed * 1000, GameOutcome::Won, 0}, id));
+        }
+    }
+    // Cut the last record short, as a crash mid-write would.
+    std::string contents;
+    CHECK(readFile(path, contents));
+    CHECK(writeFile(path, contents.substr(0, contents.size() - 5)));
+
+    bool damaged;
+    {
+        GameStore store;
+        CHECK(store.openReadOnly(path, damaged));
+        CHECK(damaged);
+        CHECK(store.size() == 2);
+    }
+    {
+        GameStore store;
+        CHECK(store.open(path));
+        CHECK(store.size() == 2);
+        CHECK(store.append(GameRecord{"tester", BoardConfig{9, 9, 10}, 4, 500, GameOutcome::Won, 0}, id));
+        CHECK(id == 2);
+    }
+    GameStore store;
+    CHECK(store.openReadOnly(path, damaged));
+    CHECK(not damaged);
+    CHECK(store.size() == 3);
+    std::vector<uint32_t> top = store.topTimes(BoardConfig{9, 9, 10}, 2);
+    CHECK(top.size() == 2 && store.record(top[0]).timeMs == 500 && store.record(top[1]).timeMs == 1000);
+    std::remove(path.c_str());
+}
+
+static void testSaveGame() {
+    const std::string path = "tests_save.bin";
+    Board board = cornerBoard();
+    SavedGame game;
+    board.snapshot(game.board);
+    game.elapsedMs = 1234;
+    game.replay = cornerReplay();
+    game.replay.moves.resize(3);
+    CHECK(writeSavedGame(path, game));
+
+    Board loaded(2, 2, 0);
+    long long elapsedMs = 0;
+    Replay replay;
+    CHECK(loadSavedGame(path, loaded, elapsedMs, replay));
+    CHECK(elapsedMs == 1234);
+    CHECK(loaded.getRevealedCount() == board.getRevealedCount());
+    CHECK(loaded.isRevealed(1, 1) && not loaded.isRevealed(2, 0));
+    CHECK(replay.moves.size() == 3);
+
+    // A flipped byte anywhere, header, cells or replay, must fail the load
+    // and leave the board as it was.
+    std::string contents, encodedReplay;
+    CHECK(readFile(path, contents));
+    encodeReplay(game.replay, encodedReplay);
+    std::size_t lastCell = contents.size() - encodedReplay.size() - 1;
+    for (std::size_t at : {std::size_t(20), lastCell, contents.size() - 1}) {
+        std::string corrupted = contents;
+        corrupted[at] ^= 0x40;
+        CHECK(writeFile(path, corrupted));
+        Board untouched(2, 2, 0);
+        CHECK(not loadSavedGame(path, untouched, elapsedMs, replay));
+        CHECK(untouched.getRows() == 2);
+    }
+    std::remove(path.c_str());
+}
+
+int main() {
+    testSolver();
+    testProbabilities();
+    testReplay();
+    testReplayLog();
+    testGameStore();
+    testSaveGame();
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
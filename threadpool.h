@@ -0,0 +1,36 @@
+#ifndef MINESWEEPER_THREADPOOL_H
+#define MINESWEEPER_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one task queue.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    bool stopping = false;
+
+    void workerLoop();
+public:
+    // Zero means one thread per hardware core.
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const;
+    void submit(std::function<void()> task);
+
+    // Runs body(0) .. body(count - 1) spread over the workers and the
+    // calling thread, and returns once every call has finished.
+    void parallelFor(int count, const std::function<void(int)>& body);
+};
+
+#endif
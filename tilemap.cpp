@@ -0,0 +1,226 @@
+#include "tilemap.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+const char* const TileAtlas::ATLAS_NAME = "tile_atlas";
+
+TileAtlas::TileAtlas(AssetCache& assets) {
+    const sf::Image& image = atlasImage(assets);
+    texture.loadFromImage(image);
+    for (int face = 0; face < FaceCount; ++face) {
+        unsigned long red = 0, green = 0, blue = 0;
+        for (unsigned y = 0; y < TILE_SIZE; ++y) {
+            for (unsigned x = 0; x < TILE_SIZE; ++x) {
+                sf::Color pixel = image.getPixel(face * TILE_SIZE + x, y);
+                red += pixel.r;
+                green += pixel.g;
+                blue += pixel.b;
+            }
+        }
+        unsigned long count = TILE_SIZE * TILE_SIZE;
+        averageColors[face] = sf::Color(static_cast<sf::Uint8>(red / count), static_cast<sf::Uint8>(green / count),
+                                        static_cast<sf::Uint8>(blue / count));
+    }
+}
+
+const sf::Image& TileAtlas::atlasImage(AssetCache& assets) {
+    if (const sf::Image* packed = assets.findImage(ATLAS_NAME)) return *packed;
+
+    const sf::Image& hidden = assets.image("photos/files/images/tile_hidden.png");
+    const sf::Image& revealed = assets.image("photos/files/images/tile_revealed.png");
+    const sf::Image& flag = assets.image("photos/files/images/flag.png");
+    const sf::Image& mine = assets.image("photos/files/images/mine.png");
+
+    sf::Image atlasImage;
+    atlasImage.create(TILE_SIZE * FaceCount, TILE_SIZE, sf::Color::Transparent);
+    auto place = [&](TileFace face, const sf::Image& base, const sf::Image* overlay) {
+        atlasImage.copy(base, face * TILE_SIZE, 0);
+        if (overlay) atlasImage.copy(*overlay, face * TILE_SIZE, 0, sf::IntRect(0, 0, 0, 0), true);
+    };
+    place(FaceHidden, hidden, nullptr);
+    place(FaceRevealed, revealed, nullptr);
+    place(FaceFlagged, hidden, &flag);
+    place(FaceHiddenMine, hidden, &mine);
+    place(FaceRevealedMine, revealed, &mine);
+    for (int i = 1; i < 9; ++i) {
+        const sf::Image& number = assets.image("photos/files/images/number_" + std::to_string(i) + ".png");
+        place(static_cast<TileFace>(FaceNumber1 + i - 1), revealed, &number);
+    }
+
+    return assets.storeImage(ATLAS_NAME, atlasImage);
+}
+
+const sf::Texture& TileAtlas::getTexture() const {
+    return texture;
+}
+
+sf::Color TileAtlas::averageColor(TileFace face) const {
+    return averageColors[face];
+}
+
+TileMap::TileMap(const TileAtlas& atlas) : vertices(sf::Quads), atlas(&atlas) {}
+
+void TileMap::resize(int numRows, int numCols, float size) {
+    rows = numRows;
+    columns = numCols;
+    tileSize = size;
+    firstRow = 0;
+    lastRow = rows;
+    firstColumn = 0;
+    lastColumn = columns;
+    // Past the largest texture the GPU takes, zoomed out views fall back to quads.
+    unsigned maxSize = sf::Texture::getMaximumSize();
+    lodAvailable = static_cast<unsigned>(columns) <= maxSize && static_cast<unsigned>(rows) <= maxSize &&
+                   lodTexture.create(columns, rows);
+    if (lodAvailable) lodImage.create(columns, rows, sf::Color::White);
+    lodFirstStale = 0;
+    lodLastStale = rows - 1;
+    useLod = false;
+    vertices.resize(static_cast<std::size_t>(rows) * columns * 4);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            sf::Vertex* quad = &vertices[(static_cast<std::size_t>(row) * columns + col) * 4];
+            quad[0].position = sf::Vector2f(col * tileSize, row * tileSize);
+            quad[1].position = sf::Vector2f((col + 1) * tileSize, row * tileSize);
+            quad[2].position = sf::Vector2f((col + 1) * tileSize, (row + 1) * tileSize);
+            quad[3].position = sf::Vector2f(col * tileSize, (row + 1) * tileSize);
+        }
+    }
+}
+
+void TileMap::setFace(int cellIndex, TileFace face) {
+    float left = static_cast<float>(face * TileAtlas::TILE_SIZE);
+    float right = left + TileAtlas::TILE_SIZE;
+    sf::Vertex* quad = &vertices[static_cast<std::size_t>(cellIndex) * 4];
+    quad[0].texCoords = sf::Vector2f(left, 0);
+    quad[1].texCoords = sf::Vector2f(right, 0);
+    quad[2].texCoords = sf::Vector2f(right, TileAtlas::TILE_SIZE);
+    quad[3].texCoords = sf::Vector2f(left, TileAtlas::TILE_SIZE);
+}
+
+// The cell's face colour tinted like its quad.
+void TileMap::updateLodPixel(int cellIndex) {
+    if (not lodAvailable) return;
+    const sf::Vertex* quad = &vertices[static_cast<std::size_t>(cellIndex) * 4];
+    TileFace face = static_cast<TileFace>(static_cast<int>(quad[0].texCoords.x) / TileAtlas::TILE_SIZE);
+    sf::Color base = atlas->averageColor(face);
+    sf::Color tint = quad[0].color;
+    lodImage.setPixel(cellIndex % columns, cellIndex / columns,
+                      sf::Color(static_cast<sf::Uint8>(base.r * tint.r / 255), static_cast<sf::Uint8>(base.g * tint.g / 255),
+                                static_cast<sf::Uint8>(base.b * tint.b / 255)));
+    int row = cellIndex / columns;
+    lodFirstStale = std::min(lodFirstStale, row);
+    lodLastStale = std::max(lodLastStale, row);
+}
+
+// Board or EndlessBoard.
+template <typename Field>
+static TileFace faceOf(Field& board, int row, int col, bool debug) {
+    switch (board.getTileState(row, col)) {
+        case TileState::Revealed: {
+            if (board.hasMine(row, col)) return FaceRevealedMine;
+            int adjacent = board.getAdjacentMines(row, col);
+            if (adjacent > 0) return static_cast<TileFace>(FaceNumber1 + adjacent - 1);
+            return FaceRevealed;
+        }
+        case TileState::Flagged:
+            return FaceFlagged;
+        case TileState::Hidden:
+            break;
+    }
+    if (debug && board.hasMine(row, col)) return FaceHiddenMine;
+    return FaceHidden;
+}
+
+// Hidden cells are shaded from green (certainly safe) to red (certainly a mine).
+static sf::Color probabilityTint(double probability) {
+    return sf::Color(static_cast<sf::Uint8>(160 + 95 * probability),
+                     static_cast<sf::Uint8>(255 - 135 * probability),
+                     static_cast<sf::Uint8>(160 - 40 * probability));
+}
+
+// Only the quads of cells the board reports as changed are rewritten; a
+// change of display mode (pause, leaderboard, debug) rewrites them all.
+// The caller marks the board dirty when the probability overlay changes.
+void TileMap::update(Board& board, bool covered, bool debug, const std::vector<double>* probabilities) {
+    if (covered != drawnCovered || debug != drawnDebug) {
+        drawnCovered = covered;
+        drawnDebug = debug;
+        board.markAllDirty();
+    }
+
+    auto refresh = [&](int row, int col) {
+        int cellIndex = row * columns + col;
+        setFace(cellIndex, covered ? FaceRevealed : faceOf(board, row, col, debug));
+        bool tinted = probabilities && not covered && board.getTileState(row, col) == TileState::Hidden;
+        setTint(cellIndex, tinted ? probabilityTint((*probabilities)[cellIndex]) : sf::Color::White);
+        // Once per cell, with both the face and the tint in place.
+        updateLodPixel(cellIndex);
+    };
+    if (board.isAllDirty()) {
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < columns; ++col) {
+                refresh(row, col);
+            }
+        }
+    } else {
+        for (int i : board.getDirtyCells()) {
+            refresh(i / columns, i % columns);
+        }
+    }
+    board.clearDirty();
+}
+
+void TileMap::update(EndlessBoard& board, int top, int left) {
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            setFace(row * columns + col, faceOf(board, top + row, left + col, false));
+            updateLodPixel(row * columns + col);
+        }
+    }
+}
+
+void TileMap::setTint(int cellIndex, sf::Color color) {
+    sf::Vertex* quad = &vertices[static_cast<std::size_t>(cellIndex) * 4];
+    for (int i = 0; i < 4; ++i) {
+        quad[i].color = color;
+    }
+}
+
+void TileMap::cull(const sf::FloatRect& visible, float pixelsPerCell) {
+    auto cellRange = [this](float from, float to, int count, int& first, int& last) {
+        first = std::max(0, std::min(count, static_cast<int>(std::floor(from / tileSize))));
+        last = std::max(first, std::min(count, static_cast<int>(std::ceil(to / tileSize))));
+    };
+    cellRange(visible.top, visible.top + visible.height, rows, firstRow, lastRow);
+    cellRange(visible.left, visible.left + visible.width, columns, firstColumn, lastColumn);
+    useLod = lodAvailable && pixelsPerCell < LOD_PIXELS_PER_CELL;
+    // Only the band of rows holding changed cells is uploaded.
+    if (useLod && lodFirstStale <= lodLastStale) {
+        const sf::Uint8* pixels = lodImage.getPixelsPtr() + static_cast<std::size_t>(lodFirstStale) * columns * 4;
+        lodTexture.update(pixels, columns, lodLastStale - lodFirstStale + 1, 0, lodFirstStale);
+        lodFirstStale = rows;
+        lodLastStale = -1;
+    }
+}
+
+void TileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (useLod) {
+        sf::Sprite sprite(lodTexture);
+        sprite.setScale(tileSize, tileSize);
+        target.draw(sprite, states);
+        return;
+    }
+    states.texture = &atlas->getTexture();
+    std::size_t count = static_cast<std::size_t>(lastColumn - firstColumn) * 4;
+    if (count == 0 || lastRow == firstRow) return;
+    // Whole rows are contiguous, so a view as wide as the board is one call.
+    if (lastColumn - firstColumn == columns) {
+        target.draw(&vertices[static_cast<std::size_t>(firstRow) * columns * 4], count * (lastRow - firstRow), sf::Quads, states);
+        return;
+    }
+    for (int row = firstRow; row < lastRow; ++row) {
+        target.draw(&vertices[(static_cast<std::size_t>(row) * columns + firstColumn) * 4], count, sf::Quads, states);
+    }
+}
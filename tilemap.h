@@ -0,0 +1,84 @@
+#ifndef MINESWEEPER_TILEMAP_H
+#define MINESWEEPER_TILEMAP_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "assetcache.h"
+#include "board.h"
+#include "endlessboard.h"
+
+// Every way a single cell can look, pre-composited so each cell is one quad.
+enum TileFace {
+    FaceHidden,
+    FaceRevealed,
+    FaceFlagged,
+    FaceHiddenMine,
+    FaceRevealedMine,
+    FaceNumber1,
+    FaceCount = FaceNumber1 + 8,
+};
+
+// All tile faces packed side by side into a single texture.
+class TileAtlas {
+private:
+    sf::Texture texture;
+    sf::Color averageColors[FaceCount];
+public:
+    static const int TILE_SIZE = 32;
+    // Cache name of the composited atlas image, also its name in a bundle.
+    static const char* const ATLAS_NAME;
+    explicit TileAtlas(AssetCache& assets);
+    // The atlas image from the cache, composited from the tile images and
+    // cached on first use.
+    static const sf::Image& atlasImage(AssetCache& assets);
+    const sf::Texture& getTexture() const;
+    // Each face averaged to one colour, for drawing a cell as one pixel.
+    sf::Color averageColor(TileFace face) const;
+};
+
+// One persistent quad per cell. Only the rows and columns inside the area
+// passed to cull() are drawn, one draw call per visible row, or one in
+// all when the view spans whole rows. Zoomed out
+// below LOD_PIXELS_PER_CELL, the board is drawn instead as a single
+// sprite from a texture with one pixel per cell, kept in step with the
+// quads and uploaded only when something changed.
+class TileMap : public sf::Drawable {
+private:
+    sf::VertexArray vertices;
+    const TileAtlas* atlas;
+    int columns = 0;
+    int rows = 0;
+    float tileSize = 0;
+    int firstRow = 0;
+    int lastRow = 0;
+    int firstColumn = 0;
+    int lastColumn = 0;
+    sf::Image lodImage;
+    sf::Texture lodTexture;
+    bool lodAvailable = false;
+    // Rows of lodImage changed since the last upload; empty when first > last.
+    int lodFirstStale = 0;
+    int lodLastStale = -1;
+    bool useLod = false;
+    bool drawnCovered = false;
+    bool drawnDebug = false;
+    void updateLodPixel(int cellIndex);
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+public:
+    static const int LOD_PIXELS_PER_CELL = 8;
+
+    explicit TileMap(const TileAtlas& atlas);
+    void resize(int numRows, int numCols, float tileSize);
+    // Set the quad only; update() refreshes the LOD pixel of each cell it rewrites.
+    void setFace(int cellIndex, TileFace face);
+    void setTint(int cellIndex, sf::Color color);
+    void update(Board& board, bool covered, bool debug, const std::vector<double>* probabilities = nullptr);
+    // Shows the part of an endless board whose top left cell is (top, left),
+    // rewriting every quad.
+    void update(EndlessBoard& board, int top, int left);
+    // Limits drawing to the cells within visible, an area in the map's
+    // own coordinates, shown at pixelsPerCell.
+    void cull(const sf::FloatRect& visible, float pixelsPerCell);
+};
+
+#endif